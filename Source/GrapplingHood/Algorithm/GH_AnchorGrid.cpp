@@ -0,0 +1,182 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GH_AnchorGrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+
+int64_t FGH_AnchorGrid::MakeCellKey(int32_t X, int32_t Y, int32_t Z)
+{
+	const int64_t Mask = (1 << 21) - 1;
+	const int64_t Offset = 1 << 20;
+	return (((X + Offset) & Mask) << 42) | (((Y + Offset) & Mask) << 21) | ((Z + Offset) & Mask);
+}
+
+void FGH_AnchorGrid::GetCellCoordinates(const FGH_SwingVector& Location, int32_t& OutX, int32_t& OutY, int32_t& OutZ) const
+{
+	OutX = static_cast<int32_t>(std::floor(Location.X / CellSize));
+	OutY = static_cast<int32_t>(std::floor(Location.Y / CellSize));
+	OutZ = static_cast<int32_t>(std::floor(Location.Z / CellSize));
+}
+
+int32_t FGH_AnchorGrid::FindCell(int64_t Key) const
+{
+	const std::vector<int64_t>::const_iterator Cell = std::lower_bound(CellKeys.begin(), CellKeys.end(), Key);
+	return Cell != CellKeys.end() && *Cell == Key ? static_cast<int32_t>(Cell - CellKeys.begin()) : -1;
+}
+
+void FGH_AnchorGrid::Build(const FGH_SwingVector* InAnchors, int32_t NumAnchors, float InCellSize)
+{
+	CellSize = InCellSize;
+
+	std::vector<std::pair<int64_t, FGH_SwingVector>> KeyedAnchors(NumAnchors);
+	for (int32_t Anchor = 0; Anchor < NumAnchors; ++Anchor)
+	{
+		int32_t X, Y, Z;
+		GetCellCoordinates(InAnchors[Anchor], X, Y, Z);
+		KeyedAnchors[Anchor] = std::make_pair(MakeCellKey(X, Y, Z), InAnchors[Anchor]);
+	}
+	std::stable_sort(KeyedAnchors.begin(), KeyedAnchors.end(), [](const std::pair<int64_t, FGH_SwingVector>& A, const std::pair<int64_t, FGH_SwingVector>& B) { return A.first < B.first; });
+
+	Anchors.resize(NumAnchors);
+	CellKeys.clear();
+	CellStarts.clear();
+	for (int32_t Anchor = 0; Anchor < NumAnchors; ++Anchor)
+	{
+		Anchors[Anchor] = KeyedAnchors[Anchor].second;
+		if (CellKeys.empty() || CellKeys.back() != KeyedAnchors[Anchor].first)
+		{
+			CellKeys.push_back(KeyedAnchors[Anchor].first);
+			CellStarts.push_back(Anchor);
+		}
+	}
+	CellStarts.push_back(NumAnchors);
+}
+
+void FGH_AnchorGrid::Assign(const FGH_SwingVector* InAnchors, int32_t NumAnchors, const int64_t* InCellKeys, const int32_t* InCellStarts, int32_t NumCells, float InCellSize)
+{
+	CellSize = InCellSize;
+	Anchors.assign(InAnchors, InAnchors + NumAnchors);
+	CellKeys.assign(InCellKeys, InCellKeys + NumCells);
+	CellStarts.assign(InCellStarts, InCellStarts + NumCells + 1);
+}
+
+int32_t FGH_AnchorGrid::FindNearestInCone(const FGH_SwingVector& Origin, const FGH_SwingVector& Direction, float CosHalfAngle, float MaxDistance) const
+{
+	if (Anchors.empty())
+	{
+		return -1;
+	}
+
+	int32_t OriginX, OriginY, OriginZ;
+	GetCellCoordinates(Origin, OriginX, OriginY, OriginZ);
+
+	const float SinHalfAngle = std::sqrt(std::max(0.f, 1.f - CosHalfAngle * CosHalfAngle));
+	const float CellRadius = CellSize * 0.8660254f;
+	const int32_t MaxRing = static_cast<int32_t>(std::ceil(MaxDistance / CellSize));
+
+	int32_t BestAnchor = -1;
+	float BestDistanceSquared = MaxDistance * MaxDistance;
+
+	// Rings of cells around the origin, any anchor in ring K is at least (K - 1) cells away
+	for (int32_t Ring = 0; Ring <= MaxRing; ++Ring)
+	{
+		const float RingDistance = (Ring - 1) * CellSize;
+		if (Ring > 1 && RingDistance * RingDistance > BestDistanceSquared)
+		{
+			break;
+		}
+
+		for (int32_t X = -Ring; X <= Ring; ++X)
+		{
+			for (int32_t Y = -Ring; Y <= Ring; ++Y)
+			{
+				// Only the cells on the ring surface, the inner ones were visited before
+				const bool bOnSurface = std::abs(X) == Ring || std::abs(Y) == Ring;
+				for (int32_t Z = -Ring; Z <= Ring; Z += (bOnSurface || Ring == 0) ? 1 : 2 * Ring)
+				{
+					// Skip the cells whose bounding sphere is outside the cone
+					const FGH_SwingVector CellCenter((OriginX + X + 0.5f) * CellSize, (OriginY + Y + 0.5f) * CellSize, (OriginZ + Z + 0.5f) * CellSize);
+					const FGH_SwingVector ToCell = CellCenter - Origin;
+					const float CellDistance = ToCell.Size();
+					if (CellDistance > CellRadius)
+					{
+						const float Along = FGH_SwingVector::Dot(ToCell, Direction);
+						const float Across = std::sqrt(std::max(0.f, CellDistance * CellDistance - Along * Along));
+						// Distance from the cell center to the cone surface
+						if (Across * CosHalfAngle - Along * SinHalfAngle > CellRadius)
+						{
+							continue;
+						}
+					}
+
+					const int32_t CellIndex = FindCell(MakeCellKey(OriginX + X, OriginY + Y, OriginZ + Z));
+					if (CellIndex < 0)
+					{
+						continue;
+					}
+
+					for (int32_t Anchor = CellStarts[CellIndex]; Anchor < CellStarts[CellIndex + 1]; ++Anchor)
+					{
+						const FGH_SwingVector ToAnchor = Anchors[Anchor] - Origin;
+						const float DistanceSquared = FGH_SwingVector::Dot(ToAnchor, ToAnchor);
+						if (DistanceSquared >= BestDistanceSquared)
+						{
+							continue;
+						}
+
+						// Squared test for the cones up to 90 degrees, the wider ones need the distance
+						const float Along = FGH_SwingVector::Dot(ToAnchor, Direction);
+						const bool bInCone = CosHalfAngle >= 0.f ? Along > 0.f && Along * Along >= CosHalfAngle * CosHalfAngle * DistanceSquared : Along >= CosHalfAngle * std::sqrt(DistanceSquared);
+						if (bInCone)
+						{
+							BestAnchor = Anchor;
+							BestDistanceSquared = DistanceSquared;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	return BestAnchor;
+}
+
+void FGH_AnchorGrid::FindInRadius(const FGH_SwingVector& Origin, float Radius, std::vector<int32_t>& OutAnchors) const
+{
+	if (Anchors.empty())
+	{
+		return;
+	}
+
+	int32_t MinX, MinY, MinZ, MaxX, MaxY, MaxZ;
+	GetCellCoordinates(Origin - FGH_SwingVector(Radius, Radius, Radius), MinX, MinY, MinZ);
+	GetCellCoordinates(Origin + FGH_SwingVector(Radius, Radius, Radius), MaxX, MaxY, MaxZ);
+
+	const float RadiusSquared = Radius * Radius;
+	for (int32_t X = MinX; X <= MaxX; ++X)
+	{
+		for (int32_t Y = MinY; Y <= MaxY; ++Y)
+		{
+			for (int32_t Z = MinZ; Z <= MaxZ; ++Z)
+			{
+				const int32_t CellIndex = FindCell(MakeCellKey(X, Y, Z));
+				if (CellIndex < 0)
+				{
+					continue;
+				}
+
+				for (int32_t Anchor = CellStarts[CellIndex]; Anchor < CellStarts[CellIndex + 1]; ++Anchor)
+				{
+					const FGH_SwingVector ToAnchor = Anchors[Anchor] - Origin;
+					if (FGH_SwingVector::Dot(ToAnchor, ToAnchor) <= RadiusSquared)
+					{
+						OutAnchors.push_back(Anchor);
+					}
+				}
+			}
+		}
+	}
+}
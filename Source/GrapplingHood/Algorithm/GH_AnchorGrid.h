@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Uniform grid over grapple anchor points, free of any engine dependency.
+
+#include "GH_Pendulum.h"
+
+#include <vector>
+
+/**
+ * Anchors bucketed in cubic cells. Only the non empty cells are stored, as sorted keys,
+ * and the anchors of a cell are contiguous so a cell lookup is a binary search followed by a linear scan.
+ */
+class FGH_AnchorGrid
+{
+public:
+	/** Sorts the anchors by cell and builds the cell table */
+	void Build(const FGH_SwingVector* InAnchors, int32_t NumAnchors, float InCellSize);
+
+	/** Takes the arrays of a grid built earlier (see GetAnchors, GetCellKeys, GetCellStarts) */
+	void Assign(const FGH_SwingVector* InAnchors, int32_t NumAnchors, const int64_t* InCellKeys, const int32_t* InCellStarts, int32_t NumCells, float InCellSize);
+
+	/**
+	 * Returns the index of the closest anchor within MaxDistance of Origin and within the cone of axis Direction
+	 * (normalized) and half angle acos(CosHalfAngle), -1 if none. A CosHalfAngle of -1 searches every direction.
+	 */
+	int32_t FindNearestInCone(const FGH_SwingVector& Origin, const FGH_SwingVector& Direction, float CosHalfAngle, float MaxDistance) const;
+
+	/** Appends the indices of the anchors within Radius of Origin, in no particular order */
+	void FindInRadius(const FGH_SwingVector& Origin, float Radius, std::vector<int32_t>& OutAnchors) const;
+
+	/** Anchors sorted by cell */
+	const std::vector<FGH_SwingVector>& GetAnchors() const { return Anchors; }
+	/** Sorted keys of the non empty cells */
+	const std::vector<int64_t>& GetCellKeys() const { return CellKeys; }
+	/** First anchor of each cell, with one extra entry holding the anchor count */
+	const std::vector<int32_t>& GetCellStarts() const { return CellStarts; }
+	float GetCellSize() const { return CellSize; }
+
+private:
+	/** Cell coordinates packed on 21 bits each */
+	static int64_t MakeCellKey(int32_t X, int32_t Y, int32_t Z);
+
+	/** Cell containing the location */
+	void GetCellCoordinates(const FGH_SwingVector& Location, int32_t& OutX, int32_t& OutY, int32_t& OutZ) const;
+
+	/** Index of the cell with the given key, -1 if the cell is empty */
+	int32_t FindCell(int64_t Key) const;
+
+	std::vector<FGH_SwingVector> Anchors;
+	std::vector<int64_t> CellKeys;
+	std::vector<int32_t> CellStarts;
+	float CellSize = 1000.f;
+};
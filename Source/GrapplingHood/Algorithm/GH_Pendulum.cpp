@@ -0,0 +1,236 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GH_Pendulum.h"
+
+#include <algorithm>
+#include <cmath>
+
+float FGH_SwingVector::Size() const
+{
+	return std::sqrt(X * X + Y * Y + Z * Z);
+}
+
+FGH_PendulumState FGH_Pendulum::Lock(const FGH_SwingVector& BodyToAnchor)
+{
+	const FGH_SwingVector Down(0.f, 0.f, -1.f);
+
+	FGH_PendulumState State;
+	State.RopeLength = BodyToAnchor.Size();
+	State.Angle = std::acos(FGH_SwingVector::Dot(BodyToAnchor, Down) / State.RopeLength);
+	State.AngleVelocity = 0.f;
+
+	State.PlaneNormal = FGH_SwingVector::Cross(Down, BodyToAnchor);
+	const float NormalSize = State.PlaneNormal.Size();
+	// Rope locked vertically, any vertical plane works
+	State.PlaneNormal = NormalSize > 1.e-4f ? State.PlaneNormal * (1.f / NormalSize) : FGH_SwingVector(0.f, 1.f, 0.f);
+
+	return State;
+}
+
+FGH_PendulumState FGH_Pendulum::Lock(const FGH_SwingVector& BodyToAnchor, const FGH_SwingVector& Velocity)
+{
+	FGH_PendulumState State = Lock(BodyToAnchor);
+
+	// Unit tangent of the swing at the locked angle, see GetVelocity
+	State.AngleVelocity = 1.f;
+	const FGH_SwingVector Tangent = GetVelocity(State) * (1.f / State.RopeLength);
+	State.AngleVelocity = FGH_SwingVector::Dot(Velocity, Tangent) / State.RopeLength;
+
+	return State;
+}
+
+float FGH_Pendulum::GetAngleAcceleration(float Angle, float RopeLength, float Gravity)
+{
+	return (Gravity / RopeLength) * std::sin(Angle);
+}
+
+void FGH_Pendulum::Reel(FGH_PendulumState& State, float NewLength)
+{
+	const float Ratio = State.RopeLength / NewLength;
+	State.AngleVelocity *= Ratio * Ratio;
+	State.RopeLength = NewLength;
+}
+
+void FGH_Pendulum::Step(FGH_PendulumState& State, const FGH_PendulumSettings& Settings, float StepSeconds)
+{
+	const float dt = StepSeconds / Settings.SubSteps;
+	const float g = Settings.Gravity;
+
+	for (int32_t SubStep = 0; SubStep < Settings.SubSteps; ++SubStep)
+	{
+		const float L = State.RopeLength;
+
+		switch (Settings.Integrator)
+		{
+		case EGH_PendulumIntegrator::Verlet:
+		{
+			const float Accel = GetAngleAcceleration(State.Angle, L, g);
+			State.Angle += State.AngleVelocity * dt + 0.5f * Accel * dt * dt;
+			State.AngleVelocity += 0.5f * (Accel + GetAngleAcceleration(State.Angle, L, g)) * dt;
+			break;
+		}
+		case EGH_PendulumIntegrator::RK4:
+		{
+			const float K1Angle = State.AngleVelocity;
+			const float K1Velocity = GetAngleAcceleration(State.Angle, L, g);
+			const float K2Angle = State.AngleVelocity + 0.5f * dt * K1Velocity;
+			const float K2Velocity = GetAngleAcceleration(State.Angle + 0.5f * dt * K1Angle, L, g);
+			const float K3Angle = State.AngleVelocity + 0.5f * dt * K2Velocity;
+			const float K3Velocity = GetAngleAcceleration(State.Angle + 0.5f * dt * K2Angle, L, g);
+			const float K4Angle = State.AngleVelocity + dt * K3Velocity;
+			const float K4Velocity = GetAngleAcceleration(State.Angle + dt * K3Angle, L, g);
+			State.Angle += (dt / 6.f) * (K1Angle + 2.f * K2Angle + 2.f * K3Angle + K4Angle);
+			State.AngleVelocity += (dt / 6.f) * (K1Velocity + 2.f * K2Velocity + 2.f * K3Velocity + K4Velocity);
+			break;
+		}
+		default:
+			State.AngleVelocity += GetAngleAcceleration(State.Angle, L, g) * dt;
+			State.Angle += State.AngleVelocity * dt;
+			break;
+		}
+
+		// The length change is applied exactly on the angular momentum, split from the swing under gravity
+		if (State.ReelSpeed != 0.f)
+		{
+			// A rope locked beyond the limits can only be reeled back towards them
+			const float ShortestLength = std::min(L, Settings.MinRopeLength);
+			const float LongestLength = std::max(L, Settings.MaxRopeLength);
+			const float NewLength = std::min(std::max(L + State.ReelSpeed * dt, ShortestLength), LongestLength);
+			Reel(State, NewLength);
+
+			// Stopped at the end of the rope, no more motion along it
+			if (NewLength == ShortestLength || NewLength == LongestLength)
+			{
+				State.ReelSpeed = 0.f;
+			}
+		}
+	}
+}
+
+FGH_SwingVector FGH_Pendulum::GetOffset(const FGH_PendulumState& State, float Angle)
+{
+	// Horizontal direction from the anchor to the body, lying in the swing plane
+	const FGH_SwingVector Horizontal = FGH_SwingVector::Cross(State.PlaneNormal, FGH_SwingVector(0.f, 0.f, 1.f));
+
+	return Horizontal * (std::sin(Angle) * State.RopeLength) + FGH_SwingVector(0.f, 0.f, std::cos(Angle) * State.RopeLength);
+}
+
+FGH_SwingVector FGH_Pendulum::GetVelocity(const FGH_PendulumState& State)
+{
+	const FGH_SwingVector Horizontal = FGH_SwingVector::Cross(State.PlaneNormal, FGH_SwingVector(0.f, 0.f, 1.f));
+	const float TangentialSpeed = State.RopeLength * State.AngleVelocity;
+
+	// Derivative of GetOffset
+	const float Sin = std::sin(State.Angle);
+	const float Cos = std::cos(State.Angle);
+	return Horizontal * (Cos * TangentialSpeed + Sin * State.ReelSpeed) + FGH_SwingVector(0.f, 0.f, Cos * State.ReelSpeed - Sin * TangentialSpeed);
+}
+
+void FGH_Pendulum::AccelerateAnchor(FGH_PendulumState& State, const FGH_SwingVector& AnchorAcceleration, float Seconds)
+{
+	// Unit tangent of the swing, see GetVelocity
+	const FGH_SwingVector Horizontal = FGH_SwingVector::Cross(State.PlaneNormal, FGH_SwingVector(0.f, 0.f, 1.f));
+	const FGH_SwingVector Tangent = Horizontal * std::cos(State.Angle) + FGH_SwingVector(0.f, 0.f, -std::sin(State.Angle));
+
+	State.AngleVelocity -= FGH_SwingVector::Dot(AnchorAcceleration, Tangent) * Seconds / State.RopeLength;
+}
+
+float FGH_Pendulum::GetTension(const FGH_PendulumState& State, float Gravity, const FGH_SwingVector& AnchorAcceleration)
+{
+	const FGH_SwingVector RopeDirection = GetOffset(State, State.Angle) * (1.f / State.RopeLength);
+	const float Tension = State.RopeLength * State.AngleVelocity * State.AngleVelocity
+		- Gravity * std::cos(State.Angle) - FGH_SwingVector::Dot(AnchorAcceleration, RopeDirection);
+
+	return std::max(Tension, 0.f);
+}
+
+float FGH_Pendulum::GetEnergy(const FGH_PendulumState& State, float Gravity)
+{
+	const float TangentialSpeed = State.RopeLength * State.AngleVelocity;
+	return 0.5f * TangentialSpeed * TangentialSpeed + Gravity * State.RopeLength * std::cos(State.Angle);
+}
+
+float FGH_Pendulum::GetSmallAnglePeriod(float RopeLength, float Gravity)
+{
+	return 2.f * 3.14159265f * std::sqrt(RopeLength / Gravity);
+}
+
+float FGH_Pendulum::GetTurnAngle(const FGH_PendulumState& State, float Gravity)
+{
+	const float TwoPi = 2.f * 3.14159265f;
+	const float Energy = GetEnergy(State, Gravity);
+	const float GravityHeight = Gravity * State.RopeLength;
+
+	// At rest the body swings towards the bottom
+	const float Angle = std::fmod(std::fmod(State.Angle, TwoPi) + TwoPi, TwoPi);
+	const float Direction = State.AngleVelocity != 0.f ? (State.AngleVelocity > 0.f ? 1.f : -1.f) : (Angle < 0.5f * TwoPi ? 1.f : -1.f);
+
+	if (Energy >= GravityHeight)
+	{
+		return State.Angle + Direction * TwoPi;
+	}
+
+	// The body turns back where all its energy is potential, cos(TurnAngle) = Energy / (g L)
+	const float TurnFromTop = std::acos(std::max(-1.f, Energy / GravityHeight));
+	const float TurnAngle = Direction > 0.f ? TwoPi - TurnFromTop : TurnFromTop;
+	return State.Angle + (TurnAngle - Angle);
+}
+
+void FGH_Pendulum::PredictArc(const FGH_PendulumState& State, float Gravity, int32_t NumPoints, FGH_SwingVector* OutOffsets)
+{
+	const float TurnAngle = GetTurnAngle(State, Gravity);
+	const float Step = NumPoints > 1 ? (TurnAngle - State.Angle) / (NumPoints - 1) : 0.f;
+
+	for (int32_t Point = 0; Point < NumPoints; ++Point)
+	{
+		OutOffsets[Point] = GetOffset(State, State.Angle + Step * Point);
+	}
+}
+
+void FGH_Pendulum::PredictRelease(const FGH_PendulumState& State, float Gravity, float Duration, int32_t NumPoints, FGH_SwingVector* OutOffsets)
+{
+	const FGH_SwingVector Start = GetOffset(State, State.Angle);
+	const FGH_SwingVector Velocity = GetVelocity(State);
+	const float Step = NumPoints > 1 ? Duration / (NumPoints - 1) : 0.f;
+
+	for (int32_t Point = 0; Point < NumPoints; ++Point)
+	{
+		const float Time = Step * Point;
+		OutOffsets[Point] = Start + Velocity * Time + FGH_SwingVector(0.f, 0.f, -0.5f * Gravity * Time * Time);
+	}
+}
+
+void FGH_FixedStepPendulum::Reset(const FGH_PendulumState& InState)
+{
+	State = InState;
+	PreviousAngle = InState.Angle;
+	TimeAccumulator = 0.f;
+}
+
+int32_t FGH_FixedStepPendulum::Advance(const FGH_PendulumSettings& Settings, float DeltaSeconds)
+{
+	TimeAccumulator += DeltaSeconds;
+
+	int32_t StepCount = 0;
+	while (TimeAccumulator >= Settings.FixedTimeStep && StepCount < Settings.MaxStepsPerFrame)
+	{
+		PreviousAngle = State.Angle;
+		FGH_Pendulum::Step(State, Settings, Settings.FixedTimeStep);
+		TimeAccumulator -= Settings.FixedTimeStep;
+		++StepCount;
+	}
+
+	// Too far behind after a hitch, drop the backlog instead of spiraling
+	if (TimeAccumulator >= Settings.FixedTimeStep)
+	{
+		TimeAccumulator = 0.f;
+	}
+
+	return StepCount;
+}
+
+float FGH_FixedStepPendulum::GetInterpolatedAngle(const FGH_PendulumSettings& Settings) const
+{
+	const float Alpha = TimeAccumulator / Settings.FixedTimeStep;
+	return PreviousAngle + (State.Angle - PreviousAngle) * Alpha;
+}
@@ -0,0 +1,141 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Swing pendulum core, kept free of any engine dependency so it can be built and profiled on its own.
+
+#include <cstdint>
+
+/** Minimal vector used by the swing core (same axes as FVector, Z up) */
+struct FGH_SwingVector
+{
+	float X = 0.f;
+	float Y = 0.f;
+	float Z = 0.f;
+
+	FGH_SwingVector() = default;
+	FGH_SwingVector(float InX, float InY, float InZ) : X(InX), Y(InY), Z(InZ) {}
+
+	FGH_SwingVector operator+(const FGH_SwingVector& Other) const { return FGH_SwingVector(X + Other.X, Y + Other.Y, Z + Other.Z); }
+	FGH_SwingVector operator-(const FGH_SwingVector& Other) const { return FGH_SwingVector(X - Other.X, Y - Other.Y, Z - Other.Z); }
+	FGH_SwingVector operator*(float Scale) const { return FGH_SwingVector(X * Scale, Y * Scale, Z * Scale); }
+
+	static float Dot(const FGH_SwingVector& A, const FGH_SwingVector& B) { return A.X * B.X + A.Y * B.Y + A.Z * B.Z; }
+	static FGH_SwingVector Cross(const FGH_SwingVector& A, const FGH_SwingVector& B) { return FGH_SwingVector(A.Y * B.Z - A.Z * B.Y, A.Z * B.X - A.X * B.Z, A.X * B.Y - A.Y * B.X); }
+
+	float Size() const;
+};
+
+/** Numerical scheme used to advance the swing pendulum */
+enum class EGH_PendulumIntegrator : uint8_t
+{
+	SemiImplicitEuler,
+	Verlet,
+	RK4
+};
+
+/** Solver configuration shared by every rope */
+struct FGH_PendulumSettings
+{
+	/** Gravity acceleration (positive, in cm/s^2) */
+	float Gravity = 980.f;
+	/** Duration of one solver step (in s) */
+	float FixedTimeStep = 1.f / 60.f;
+	/** Number of integration sub steps inside each fixed step */
+	int32_t SubSteps = 2;
+	/** Maximum fixed steps run in one frame, the remaining time is dropped after a hitch */
+	int32_t MaxStepsPerFrame = 8;
+	/** Shortest and longest rope the body can be reeled to (in cm) */
+	float MinRopeLength = 100.f;
+	float MaxRopeLength = 5000.f;
+	EGH_PendulumIntegrator Integrator = EGH_PendulumIntegrator::SemiImplicitEuler;
+};
+
+/** State of a locked rope, the body swings in the vertical plane of normal PlaneNormal */
+struct FGH_PendulumState
+{
+	float RopeLength = 0.f;
+	/** Angle of the rope from the upward vertical at the anchor (PI when hanging still) */
+	float Angle = 0.f;
+	float AngleVelocity = 0.f;
+	FGH_SwingVector PlaneNormal;
+	/** Rate the rope length changes at (in cm/s), negative while reeling in */
+	float ReelSpeed = 0.f;
+};
+
+/** Stateless pendulum math */
+struct FGH_Pendulum
+{
+	/** Builds the state of a rope locked between the body and the anchor */
+	static FGH_PendulumState Lock(const FGH_SwingVector& BodyToAnchor);
+
+	/** Builds the state of a rope locked on a moving body, keeping the part of the velocity lying in the swing plane */
+	static FGH_PendulumState Lock(const FGH_SwingVector& BodyToAnchor, const FGH_SwingVector& Velocity);
+
+	/** Angular acceleration at the given angle */
+	static float GetAngleAcceleration(float Angle, float RopeLength, float Gravity);
+
+	/**
+	 * Changes the rope length, scaling the angular velocity by (RopeLength / NewLength)^2 so the angular momentum
+	 * around the anchor is kept. Reeling in speeds the swing up by the work of the rope, reeling out slows it down.
+	 */
+	static void Reel(FGH_PendulumState& State, float NewLength);
+
+	/** Advances the state by one fixed step, split into Settings.SubSteps sub steps, the rope reeled by State.ReelSpeed after each one */
+	static void Step(FGH_PendulumState& State, const FGH_PendulumSettings& Settings, float StepSeconds);
+
+	/** Offset from the anchor to the body for the given angle */
+	static FGH_SwingVector GetOffset(const FGH_PendulumState& State, float Angle);
+
+	/** Velocity of the body, tangent to the swing plus the reeling along the rope */
+	static FGH_SwingVector GetVelocity(const FGH_PendulumState& State);
+
+	/**
+	 * Applies the acceleration of a moving anchor over Seconds. The pendulum swings in the frame of the anchor,
+	 * where the body feels the acceleration the other way. Only its part along the swing is kept.
+	 */
+	static void AccelerateAnchor(FGH_PendulumState& State, const FGH_SwingVector& AnchorAcceleration, float Seconds);
+
+	/**
+	 * Rope tension per unit of mass (in cm/s^2): the centripetal pull plus gravity and the anchor acceleration
+	 * along the rope. 0 when the rope goes slack.
+	 */
+	static float GetTension(const FGH_PendulumState& State, float Gravity, const FGH_SwingVector& AnchorAcceleration);
+
+	/** Mechanical energy per unit of mass, constant for an exact solver */
+	static float GetEnergy(const FGH_PendulumState& State, float Gravity);
+
+	/** Analytic period of small oscillations around the rest position */
+	static float GetSmallAnglePeriod(float RopeLength, float Gravity);
+
+	/**
+	 * Angle the swing reaches before turning back, found from the energy without stepping the solver.
+	 * A swing with enough energy to go over the anchor returns the angle one full turn away.
+	 */
+	static float GetTurnAngle(const FGH_PendulumState& State, float Gravity);
+
+	/** Writes NumPoints offsets from the anchor to the body, evenly spread from the current angle to the turn angle */
+	static void PredictArc(const FGH_PendulumState& State, float Gravity, int32_t NumPoints, FGH_SwingVector* OutOffsets);
+
+	/** Writes NumPoints offsets from the anchor to the body over the Duration seconds of free fall following a release now */
+	static void PredictRelease(const FGH_PendulumState& State, float Gravity, float Duration, int32_t NumPoints, FGH_SwingVector* OutOffsets);
+};
+
+/** Runs a pendulum at a fixed rate independently of the frame time */
+struct FGH_FixedStepPendulum
+{
+	FGH_PendulumState State;
+	/** Angle at the previous solver step, used to interpolate the rendered position */
+	float PreviousAngle = 0.f;
+	/** Time not yet consumed by the solver */
+	float TimeAccumulator = 0.f;
+
+	/** Restarts the solver from the given state */
+	void Reset(const FGH_PendulumState& InState);
+
+	/** Consumes the frame time in fixed steps, returns the number of steps run */
+	int32_t Advance(const FGH_PendulumSettings& Settings, float DeltaSeconds);
+
+	/** Angle between the last two solver states matching the unconsumed time */
+	float GetInterpolatedAngle(const FGH_PendulumSettings& Settings) const;
+};
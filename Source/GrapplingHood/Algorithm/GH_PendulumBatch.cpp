@@ -0,0 +1,188 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GH_PendulumBatch.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GH_PENDULUM_BATCH_SSE2 1
+#define GH_PENDULUM_BATCH_NEON 0
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define GH_PENDULUM_BATCH_SSE2 0
+#define GH_PENDULUM_BATCH_NEON 1
+#else
+#define GH_PENDULUM_BATCH_SSE2 0
+#define GH_PENDULUM_BATCH_NEON 0
+#endif
+
+#if GH_PENDULUM_BATCH_SSE2 || GH_PENDULUM_BATCH_NEON
+
+// Four float lanes. Comparisons return lanes with all bits set where true.
+// The names stay clear of the engine vector macros, the file can share a unity build with them
+namespace GHPendulumBatch
+{
+#if GH_PENDULUM_BATCH_SSE2
+	typedef __m128 FLanes;
+
+	static inline FLanes LanesLoad(const float* Data) { return _mm_loadu_ps(Data); }
+	static inline void LanesStore(float* Data, FLanes A) { _mm_storeu_ps(Data, A); }
+	static inline FLanes LanesSplat(float Value) { return _mm_set1_ps(Value); }
+	static inline FLanes LanesAdd(FLanes A, FLanes B) { return _mm_add_ps(A, B); }
+	static inline FLanes LanesSub(FLanes A, FLanes B) { return _mm_sub_ps(A, B); }
+	static inline FLanes LanesMul(FLanes A, FLanes B) { return _mm_mul_ps(A, B); }
+	static inline FLanes LanesDiv(FLanes A, FLanes B) { return _mm_div_ps(A, B); }
+	static inline FLanes LanesMin(FLanes A, FLanes B) { return _mm_min_ps(A, B); }
+	static inline FLanes LanesMax(FLanes A, FLanes B) { return _mm_max_ps(A, B); }
+	static inline FLanes LanesEqual(FLanes A, FLanes B) { return _mm_cmpeq_ps(A, B); }
+	static inline FLanes LanesNotEqual(FLanes A, FLanes B) { return _mm_cmpneq_ps(A, B); }
+	static inline FLanes LanesGreater(FLanes A, FLanes B) { return _mm_cmpgt_ps(A, B); }
+	static inline FLanes LanesAnd(FLanes A, FLanes B) { return _mm_and_ps(A, B); }
+	static inline FLanes LanesAndNot(FLanes Mask, FLanes A) { return _mm_andnot_ps(Mask, A); }
+	static inline FLanes LanesOr(FLanes A, FLanes B) { return _mm_or_ps(A, B); }
+	/** Lanes of A where Mask is set, of B elsewhere */
+	static inline FLanes LanesSelect(FLanes Mask, FLanes A, FLanes B) { return _mm_or_ps(_mm_and_ps(Mask, A), _mm_andnot_ps(Mask, B)); }
+	static inline bool LanesAny(FLanes Mask) { return _mm_movemask_ps(Mask) != 0; }
+	/** Rounds to the nearest integer, the angles stay far below 2^31 */
+	static inline FLanes LanesRound(FLanes A) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(A)); }
+#else
+	typedef float32x4_t FLanes;
+
+	static inline FLanes LanesLoad(const float* Data) { return vld1q_f32(Data); }
+	static inline void LanesStore(float* Data, FLanes A) { vst1q_f32(Data, A); }
+	static inline FLanes LanesSplat(float Value) { return vdupq_n_f32(Value); }
+	static inline FLanes LanesAdd(FLanes A, FLanes B) { return vaddq_f32(A, B); }
+	static inline FLanes LanesSub(FLanes A, FLanes B) { return vsubq_f32(A, B); }
+	static inline FLanes LanesMul(FLanes A, FLanes B) { return vmulq_f32(A, B); }
+	static inline FLanes LanesDiv(FLanes A, FLanes B) { return vdivq_f32(A, B); }
+	static inline FLanes LanesMin(FLanes A, FLanes B) { return vminq_f32(A, B); }
+	static inline FLanes LanesMax(FLanes A, FLanes B) { return vmaxq_f32(A, B); }
+	static inline FLanes LanesEqual(FLanes A, FLanes B) { return vreinterpretq_f32_u32(vceqq_f32(A, B)); }
+	static inline FLanes LanesNotEqual(FLanes A, FLanes B) { return vreinterpretq_f32_u32(vmvnq_u32(vceqq_f32(A, B))); }
+	static inline FLanes LanesGreater(FLanes A, FLanes B) { return vreinterpretq_f32_u32(vcgtq_f32(A, B)); }
+	static inline FLanes LanesAnd(FLanes A, FLanes B) { return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(A), vreinterpretq_u32_f32(B))); }
+	static inline FLanes LanesAndNot(FLanes Mask, FLanes A) { return vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(A), vreinterpretq_u32_f32(Mask))); }
+	static inline FLanes LanesOr(FLanes A, FLanes B) { return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(A), vreinterpretq_u32_f32(B))); }
+	/** Lanes of A where Mask is set, of B elsewhere */
+	static inline FLanes LanesSelect(FLanes Mask, FLanes A, FLanes B) { return vbslq_f32(vreinterpretq_u32_f32(Mask), A, B); }
+	static inline bool LanesAny(FLanes Mask) { return vmaxvq_u32(vreinterpretq_u32_f32(Mask)) != 0; }
+	/** Rounds to the nearest integer */
+	static inline FLanes LanesRound(FLanes A) { return vrndnq_f32(A); }
+#endif
+
+	/** Sine of four angles, absolute error below 1e-7 */
+	static inline FLanes LanesSin(FLanes X)
+	{
+		const float Pi = 3.14159265358979f;
+
+		// Back to [-PI, PI], 2 PI split in an exactly representable part and the rest (Cody-Waite)
+		const FLanes Turns = LanesRound(LanesMul(X, LanesSplat(0.5f / Pi)));
+		X = LanesSub(LanesSub(X, LanesMul(Turns, LanesSplat(6.28125f))), LanesMul(Turns, LanesSplat(1.93530717958647692e-3f)));
+
+		// Folded to [-PI/2, PI/2] with sin(PI - X) = sin(X)
+		const FLanes HalfPi = LanesSplat(0.5f * Pi);
+		const FLanes Above = LanesGreater(X, HalfPi);
+		const FLanes Below = LanesGreater(LanesSub(LanesSplat(0.f), HalfPi), X);
+		X = LanesSelect(Above, LanesSub(LanesSplat(Pi), X), LanesSelect(Below, LanesSub(LanesSplat(-Pi), X), X));
+
+		// Taylor series up to X^11, the next term is below 6e-8 at PI/2
+		const FLanes X2 = LanesMul(X, X);
+		FLanes Series = LanesSplat(-1.f / 39916800.f);
+		Series = LanesAdd(LanesMul(Series, X2), LanesSplat(1.f / 362880.f));
+		Series = LanesAdd(LanesMul(Series, X2), LanesSplat(-1.f / 5040.f));
+		Series = LanesAdd(LanesMul(Series, X2), LanesSplat(1.f / 120.f));
+		Series = LanesAdd(LanesMul(Series, X2), LanesSplat(-1.f / 6.f));
+		Series = LanesAdd(LanesMul(Series, X2), LanesSplat(1.f));
+		return LanesMul(Series, X);
+	}
+}
+
+#endif
+
+void FGH_PendulumBatch::StepSemiImplicitEuler(float* Angle, float* AngleVelocity, float* PreviousAngle, float* RopeLength, float* ReelSpeed, int32_t NumRopes, const FGH_PendulumSettings& Settings)
+{
+	int32_t Rope = 0;
+
+#if GH_PENDULUM_BATCH_SSE2 || GH_PENDULUM_BATCH_NEON
+	using namespace GHPendulumBatch;
+
+	const float dt = Settings.FixedTimeStep / Settings.SubSteps;
+	const FLanes Dt = LanesSplat(dt);
+	const FLanes GravityDt = LanesSplat(Settings.Gravity * dt);
+	const FLanes MinLength = LanesSplat(Settings.MinRopeLength);
+	const FLanes MaxLength = LanesSplat(Settings.MaxRopeLength);
+	const FLanes Zero = LanesSplat(0.f);
+
+	for (; Rope + 4 <= NumRopes; Rope += 4)
+	{
+		FLanes RopeAngle = LanesLoad(Angle + Rope);
+		FLanes RopeVelocity = LanesLoad(AngleVelocity + Rope);
+		FLanes Length = LanesLoad(RopeLength + Rope);
+		FLanes AccelDt = LanesDiv(GravityDt, Length);
+		const FLanes Reel = LanesLoad(ReelSpeed + Rope);
+
+		LanesStore(PreviousAngle + Rope, RopeAngle);
+
+		// Most ropes keep their length, they skip the reel update
+		FLanes Reeling = LanesNotEqual(Reel, Zero);
+		if (!LanesAny(Reeling))
+		{
+			for (int32_t SubStep = 0; SubStep < Settings.SubSteps; ++SubStep)
+			{
+				RopeVelocity = LanesAdd(RopeVelocity, LanesMul(AccelDt, LanesSin(RopeAngle)));
+				RopeAngle = LanesAdd(RopeAngle, LanesMul(RopeVelocity, Dt));
+			}
+		}
+		else
+		{
+			const FLanes ReelDt = LanesMul(Reel, Dt);
+			for (int32_t SubStep = 0; SubStep < Settings.SubSteps; ++SubStep)
+			{
+				RopeVelocity = LanesAdd(RopeVelocity, LanesMul(AccelDt, LanesSin(RopeAngle)));
+				RopeAngle = LanesAdd(RopeAngle, LanesMul(RopeVelocity, Dt));
+
+				// Same as FGH_Pendulum::Step, clamped to the limits or to the current length when beyond them
+				const FLanes ShortestLength = LanesMin(Length, MinLength);
+				const FLanes LongestLength = LanesMax(Length, MaxLength);
+				const FLanes NewLength = LanesMin(LanesMax(LanesAdd(Length, ReelDt), ShortestLength), LongestLength);
+				const FLanes Ratio = LanesDiv(Length, NewLength);
+
+				// The other ropes of the group keep their length and velocity
+				RopeVelocity = LanesSelect(Reeling, LanesMul(RopeVelocity, LanesMul(Ratio, Ratio)), RopeVelocity);
+				Length = LanesSelect(Reeling, NewLength, Length);
+				AccelDt = LanesDiv(GravityDt, Length);
+
+				// Ropes stopped at either end no longer move along the rope
+				const FLanes AtEnd = LanesOr(LanesEqual(NewLength, ShortestLength), LanesEqual(NewLength, LongestLength));
+				Reeling = LanesAndNot(AtEnd, Reeling);
+			}
+
+			LanesStore(ReelSpeed + Rope, LanesSelect(Reeling, Reel, Zero));
+			LanesStore(RopeLength + Rope, Length);
+		}
+
+		LanesStore(Angle + Rope, RopeAngle);
+		LanesStore(AngleVelocity + Rope, RopeVelocity);
+	}
+#endif
+
+	// Remaining ropes
+	FGH_PendulumSettings EulerSettings = Settings;
+	EulerSettings.Integrator = EGH_PendulumIntegrator::SemiImplicitEuler;
+
+	for (; Rope < NumRopes; ++Rope)
+	{
+		FGH_PendulumState State;
+		State.RopeLength = RopeLength[Rope];
+		State.Angle = Angle[Rope];
+		State.AngleVelocity = AngleVelocity[Rope];
+		State.ReelSpeed = ReelSpeed[Rope];
+
+		PreviousAngle[Rope] = State.Angle;
+		FGH_Pendulum::Step(State, EulerSettings, EulerSettings.FixedTimeStep);
+
+		Angle[Rope] = State.Angle;
+		AngleVelocity[Rope] = State.AngleVelocity;
+		RopeLength[Rope] = State.RopeLength;
+		ReelSpeed[Rope] = State.ReelSpeed;
+	}
+}
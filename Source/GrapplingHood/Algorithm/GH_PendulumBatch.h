@@ -0,0 +1,21 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Batched pendulum update over ropes stored as arrays, free of any engine dependency.
+
+#include "GH_Pendulum.h"
+
+/**
+ * Semi-implicit Euler update of many ropes at once, four ropes per SSE2 or NEON instruction
+ * (one by one through FGH_Pendulum::Step on the other targets).
+ * Gives the results of FGH_Pendulum::Step up to the precision of the vector sine, below 1e-7.
+ */
+struct FGH_PendulumBatch
+{
+	/**
+	 * Advances the ropes [0, NumRopes) by one fixed step of Settings.FixedTimeStep, split into Settings.SubSteps sub steps.
+	 * The angle before the step is written to PreviousAngle, the reel speed of the ropes stopped at an end is set to 0.
+	 */
+	static void StepSemiImplicitEuler(float* Angle, float* AngleVelocity, float* PreviousAngle, float* RopeLength, float* ReelSpeed, int32_t NumRopes, const FGH_PendulumSettings& Settings);
+};
@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GH_RopeConstraints.h"
+
+#include <cmath>
+
+void FGH_RopeConstraints::Project(FGH_SwingVector& Position, const FGH_SwingVector* Anchors, const float* RopeLengths, int32_t NumRopes, int32_t Iterations)
+{
+	for (int32_t Iteration = 0; Iteration < Iterations; ++Iteration)
+	{
+		bool bMoved = false;
+		for (int32_t Rope = 0; Rope < NumRopes; ++Rope)
+		{
+			const FGH_SwingVector AnchorToBody = Position - Anchors[Rope];
+			const float DistanceSquared = FGH_SwingVector::Dot(AnchorToBody, AnchorToBody);
+			if (DistanceSquared <= RopeLengths[Rope] * RopeLengths[Rope])
+			{
+				continue;
+			}
+
+			// Taut rope, pull the body back on the sphere of the rope length
+			const float Distance = std::sqrt(DistanceSquared);
+			Position = Anchors[Rope] + AnchorToBody * (RopeLengths[Rope] / Distance);
+			bMoved = true;
+		}
+
+		// Every rope satisfied, the other passes would not move the body
+		if (!bMoved)
+		{
+			break;
+		}
+	}
+}
+
+void FGH_RopeConstraints::Step(FGH_SwingVector& Position, FGH_SwingVector& Velocity, const FGH_SwingVector* Anchors, const float* RopeLengths, int32_t NumRopes, const FGH_RopeConstraintSettings& Settings, float StepSeconds)
+{
+	const float dt = StepSeconds / Settings.SubSteps;
+	const FGH_SwingVector GravityDt(0.f, 0.f, -Settings.Gravity * dt);
+
+	for (int32_t SubStep = 0; SubStep < Settings.SubSteps; ++SubStep)
+	{
+		Velocity = Velocity + GravityDt;
+
+		// Taut ropes stop the body moving away from their anchor
+		for (int32_t Iteration = 0; Iteration < Settings.Iterations; ++Iteration)
+		{
+			for (int32_t Rope = 0; Rope < NumRopes; ++Rope)
+			{
+				const FGH_SwingVector AnchorToBody = Position - Anchors[Rope];
+				const float Distance = AnchorToBody.Size();
+				if (Distance < RopeLengths[Rope] - 0.01f || Distance <= 0.f)
+				{
+					continue;
+				}
+
+				const FGH_SwingVector RopeDirection = AnchorToBody * (1.f / Distance);
+				const float Outward = FGH_SwingVector::Dot(Velocity, RopeDirection);
+				if (Outward > 0.f)
+				{
+					Velocity = Velocity - RopeDirection * Outward;
+				}
+			}
+		}
+
+		// The tangent move still drifts outside the ropes, the projection brings the body back without changing its velocity
+		Position = Position + Velocity * dt;
+		Project(Position, Anchors, RopeLengths, NumRopes, Settings.Iterations);
+	}
+}
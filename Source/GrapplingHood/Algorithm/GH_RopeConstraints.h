@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Point mass held by several ropes, free of any engine dependency.
+
+#include "GH_Pendulum.h"
+
+/** Most ropes holding one body */
+#define GH_MAX_ROPES_PER_BODY 4
+
+/** Solver configuration shared by every body */
+struct FGH_RopeConstraintSettings
+{
+	/** Gravity acceleration (positive, in cm/s^2) */
+	float Gravity = 980.f;
+	/** Number of integration sub steps inside each step */
+	int32_t SubSteps = 2;
+	/** Number of passes over the ropes per sub step, more passes settle bodies pulled by opposing ropes */
+	int32_t Iterations = 4;
+};
+
+/**
+ * Body under gravity held by up to GH_MAX_ROPES_PER_BODY ropes, each rope keeping the body within its length of its anchor.
+ * The taut ropes remove the velocity pulling away from their anchor, then the moved body is projected back inside every rope.
+ * Slack ropes do not act, so a single rope behaves like the pendulum with the body able to fall inside its length.
+ */
+struct FGH_RopeConstraints
+{
+	/** Advances the body by one step, split into Settings.SubSteps sub steps */
+	static void Step(FGH_SwingVector& Position, FGH_SwingVector& Velocity, const FGH_SwingVector* Anchors, const float* RopeLengths, int32_t NumRopes, const FGH_RopeConstraintSettings& Settings, float StepSeconds);
+
+	/** Moves the position inside every rope, in Iterations passes */
+	static void Project(FGH_SwingVector& Position, const FGH_SwingVector* Anchors, const float* RopeLengths, int32_t NumRopes, int32_t Iterations);
+};
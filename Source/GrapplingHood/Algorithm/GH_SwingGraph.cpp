@@ -0,0 +1,142 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GH_SwingGraph.h"
+
+#include <algorithm>
+#include <functional>
+
+void FGH_SwingGraph::Build(const FGH_AnchorGrid& Grid, const FGH_SwingLinkSettings& Settings, const FGH_SwingLinkFilter& Filter)
+{
+	const std::vector<FGH_SwingVector>& Anchors = Grid.GetAnchors();
+	const int32_t NumAnchors = static_cast<int32_t>(Anchors.size());
+	const float MinDistanceSquared = Settings.MinDistance * Settings.MinDistance;
+
+	LinkStarts.resize(NumAnchors + 1);
+	Links.clear();
+
+	std::vector<int32_t> Candidates;
+	std::vector<std::pair<float, int32_t>> AnchorLinks;
+
+	for (int32_t Anchor = 0; Anchor < NumAnchors; ++Anchor)
+	{
+		LinkStarts[Anchor] = static_cast<int32_t>(Links.size());
+
+		Candidates.clear();
+		Grid.FindInRadius(Anchors[Anchor], Settings.MaxDistance, Candidates);
+
+		AnchorLinks.clear();
+		for (const int32_t Candidate : Candidates)
+		{
+			const FGH_SwingVector ToCandidate = Anchors[Candidate] - Anchors[Anchor];
+			const float DistanceSquared = FGH_SwingVector::Dot(ToCandidate, ToCandidate);
+			if (DistanceSquared >= MinDistanceSquared && ToCandidate.Z <= Settings.MaxClimb && -ToCandidate.Z <= Settings.MaxDrop)
+			{
+				AnchorLinks.push_back(std::make_pair(DistanceSquared, Candidate));
+			}
+		}
+
+		const std::size_t MaxLinks = static_cast<std::size_t>(std::max(Settings.MaxLinksPerAnchor, 0));
+		if (!Filter)
+		{
+			const std::size_t NumLinks = std::min(AnchorLinks.size(), MaxLinks);
+			std::partial_sort(AnchorLinks.begin(), AnchorLinks.begin() + NumLinks, AnchorLinks.end());
+			for (std::size_t Link = 0; Link < NumLinks; ++Link)
+			{
+				Links.push_back(AnchorLinks[Link].second);
+			}
+			continue;
+		}
+
+		// Filtered candidates do not take the place of the farther ones
+		std::sort(AnchorLinks.begin(), AnchorLinks.end());
+		const std::size_t FirstLink = Links.size();
+		for (std::size_t Link = 0; Link < AnchorLinks.size() && Links.size() - FirstLink < MaxLinks; ++Link)
+		{
+			if (Filter(Anchor, AnchorLinks[Link].second))
+			{
+				Links.push_back(AnchorLinks[Link].second);
+			}
+		}
+	}
+
+	LinkStarts[NumAnchors] = static_cast<int32_t>(Links.size());
+}
+
+void FGH_SwingGraph::Assign(const int32_t* InLinkStarts, int32_t NumAnchors, const int32_t* InLinks, int32_t NumLinks)
+{
+	LinkStarts.assign(InLinkStarts, InLinkStarts + NumAnchors + 1);
+	Links.assign(InLinks, InLinks + NumLinks);
+}
+
+bool FGH_SwingGraph::FindPath(const FGH_AnchorGrid& Grid, int32_t Start, int32_t Goal, int32_t MaxExpansions, FGH_SwingGraphSearch& Search, std::vector<int32_t>& OutPath) const
+{
+	OutPath.clear();
+
+	const int32_t NumAnchors = GetNumAnchors();
+	if (Start < 0 || Start >= NumAnchors || Goal < 0 || Goal >= NumAnchors)
+	{
+		return false;
+	}
+
+	const std::vector<FGH_SwingVector>& Anchors = Grid.GetAnchors();
+
+	// Stamps tell the anchors reached by this search apart, the arrays are only cleared when the counter wraps
+	if (Search.Stamp.size() != static_cast<std::size_t>(NumAnchors) || ++Search.Search == 0)
+	{
+		Search.Cost.resize(NumAnchors);
+		Search.Previous.resize(NumAnchors);
+		Search.Stamp.assign(NumAnchors, 0);
+		Search.Search = 1;
+	}
+	Search.Open.clear();
+
+	const std::greater<std::pair<float, int32_t>> MinHeap;
+	const auto Estimate = [&Anchors, Goal](int32_t Anchor) { return (Anchors[Goal] - Anchors[Anchor]).Size(); };
+
+	Search.Cost[Start] = 0.f;
+	Search.Previous[Start] = -1;
+	Search.Stamp[Start] = Search.Search;
+	Search.Open.push_back(std::make_pair(Estimate(Start), Start));
+
+	for (int32_t Expansion = 0; !Search.Open.empty() && Expansion < MaxExpansions; ++Expansion)
+	{
+		std::pop_heap(Search.Open.begin(), Search.Open.end(), MinHeap);
+		const std::pair<float, int32_t> Current = Search.Open.back();
+		Search.Open.pop_back();
+
+		const int32_t Anchor = Current.second;
+		if (Anchor == Goal)
+		{
+			for (int32_t PathAnchor = Goal; PathAnchor != -1; PathAnchor = Search.Previous[PathAnchor])
+			{
+				OutPath.push_back(PathAnchor);
+			}
+			std::reverse(OutPath.begin(), OutPath.end());
+			return true;
+		}
+
+		// Stale entry, the anchor was reached again with a lower cost since it was pushed
+		if (Current.first > Search.Cost[Anchor] + Estimate(Anchor))
+		{
+			continue;
+		}
+
+		for (int32_t Link = LinkStarts[Anchor]; Link < LinkStarts[Anchor + 1]; ++Link)
+		{
+			const int32_t Next = Links[Link];
+			const float Cost = Search.Cost[Anchor] + (Anchors[Next] - Anchors[Anchor]).Size();
+			if (Search.Stamp[Next] == Search.Search && Cost >= Search.Cost[Next])
+			{
+				continue;
+			}
+
+			Search.Cost[Next] = Cost;
+			Search.Previous[Next] = Anchor;
+			Search.Stamp[Next] = Search.Search;
+			Search.Open.push_back(std::make_pair(Cost + Estimate(Next), Next));
+			std::push_heap(Search.Open.begin(), Search.Open.end(), MinHeap);
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Graph of the swings linking the grapple anchors, free of any engine dependency.
+
+#include "GH_AnchorGrid.h"
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+/** Rules deciding which anchor can be reached by swinging from another */
+struct FGH_SwingLinkSettings
+{
+	/** Farthest anchor reached from a swing (in cm) */
+	float MaxDistance = 3000.f;
+	/** Closer anchors are skipped, releasing the rope so early is not worth it (in cm) */
+	float MinDistance = 300.f;
+	/** Highest the next anchor can be above the current one (in cm) */
+	float MaxClimb = 300.f;
+	/** Lowest the next anchor can be below the current one (in cm) */
+	float MaxDrop = 2000.f;
+	/** Only the closest links of an anchor are kept */
+	int32_t MaxLinksPerAnchor = 16;
+};
+
+/** Working memory of a path search, kept between the searches so they do not allocate */
+struct FGH_SwingGraphSearch
+{
+	/** Cost from the start and previous anchor on the best path found, valid when the stamp matches the search */
+	std::vector<float> Cost;
+	std::vector<int32_t> Previous;
+	std::vector<uint32_t> Stamp;
+	/** Open anchors as (estimated total cost, anchor), ordered as a min heap */
+	std::vector<std::pair<float, int32_t>> Open;
+	uint32_t Search = 0;
+};
+
+/**
+ * Returns whether the swing from anchor From to anchor To is possible beyond the distance rules, e.g. nothing
+ * blocks the line between them. Called with the anchor indices of the grid.
+ */
+typedef std::function<bool(int32_t From, int32_t To)> FGH_SwingLinkFilter;
+
+/**
+ * Directed links between the anchors of a grid, stored as compressed rows:
+ * the links of anchor A are Links[LinkStarts[A]] to Links[LinkStarts[A + 1] - 1], closest first.
+ * Only swings are linked, the walks between anchors on the ground are not part of the graph.
+ */
+class FGH_SwingGraph
+{
+public:
+	/**
+	 * Links every anchor of the grid to the anchors reachable by swinging from it.
+	 * @param Filter	Optional, called on the candidates closest first until MaxLinksPerAnchor links are kept
+	 */
+	void Build(const FGH_AnchorGrid& Grid, const FGH_SwingLinkSettings& Settings, const FGH_SwingLinkFilter& Filter = FGH_SwingLinkFilter());
+
+	/** Takes the arrays of a graph built earlier (see GetLinkStarts, GetLinks) */
+	void Assign(const int32_t* InLinkStarts, int32_t NumAnchors, const int32_t* InLinks, int32_t NumLinks);
+
+	/**
+	 * A* search from the Start anchor to the Goal anchor, the links cost their length.
+	 * @param MaxExpansions	Anchors visited before giving up, bounds the cost of an unreachable goal
+	 * @return false if no path was found, else OutPath holds the anchors from Start to Goal
+	 */
+	bool FindPath(const FGH_AnchorGrid& Grid, int32_t Start, int32_t Goal, int32_t MaxExpansions, FGH_SwingGraphSearch& Search, std::vector<int32_t>& OutPath) const;
+
+	int32_t GetNumAnchors() const { return LinkStarts.empty() ? 0 : static_cast<int32_t>(LinkStarts.size()) - 1; }
+	int32_t GetNumLinks() const { return static_cast<int32_t>(Links.size()); }
+
+	/** First link of each anchor, with one extra entry holding the link count */
+	const std::vector<int32_t>& GetLinkStarts() const { return LinkStarts; }
+	/** Target anchor of each link */
+	const std::vector<int32_t>& GetLinks() const { return Links; }
+
+private:
+	std::vector<int32_t> LinkStarts;
+	std::vector<int32_t> Links;
+};
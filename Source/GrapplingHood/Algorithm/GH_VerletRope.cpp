@@ -0,0 +1,115 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GH_VerletRope.h"
+
+void FGH_VerletRope::Reset(int32_t NumSegments, const FGH_SwingVector& Start, const FGH_SwingVector& End)
+{
+	NumSegments = NumSegments < 1 ? 1 : NumSegments;
+
+	Positions.resize(NumSegments + 1);
+	for (int32_t Point = 0; Point <= NumSegments; ++Point)
+	{
+		Positions[Point] = Start + (End - Start) * (static_cast<float>(Point) / NumSegments);
+	}
+	PreviousPositions = Positions;
+}
+
+void FGH_VerletRope::Resample(int32_t NumSegments)
+{
+	NumSegments = NumSegments < 1 ? 1 : NumSegments;
+	if (Positions.size() < 2 || NumSegments == GetNumSegments())
+	{
+		return;
+	}
+
+	// Cumulated length along the current polyline
+	std::vector<float> Distances(Positions.size(), 0.f);
+	for (std::size_t Point = 1; Point < Positions.size(); ++Point)
+	{
+		Distances[Point] = Distances[Point - 1] + (Positions[Point] - Positions[Point - 1]).Size();
+	}
+
+	// Previous positions are sampled at the same spots, the particles keep the velocity of the rope there
+	std::vector<FGH_SwingVector> Resampled(NumSegments + 1);
+	std::vector<FGH_SwingVector> ResampledPrevious(NumSegments + 1);
+	std::size_t Segment = 1;
+	for (int32_t Point = 0; Point <= NumSegments; ++Point)
+	{
+		const float Distance = Distances.back() * Point / NumSegments;
+		while (Segment < Positions.size() - 1 && Distances[Segment] < Distance)
+		{
+			++Segment;
+		}
+
+		const float SegmentLength = Distances[Segment] - Distances[Segment - 1];
+		const float Alpha = SegmentLength > 0.f ? (Distance - Distances[Segment - 1]) / SegmentLength : 0.f;
+		Resampled[Point] = Positions[Segment - 1] + (Positions[Segment] - Positions[Segment - 1]) * Alpha;
+		ResampledPrevious[Point] = PreviousPositions[Segment - 1] + (PreviousPositions[Segment] - PreviousPositions[Segment - 1]) * Alpha;
+	}
+
+	Positions.swap(Resampled);
+	PreviousPositions.swap(ResampledPrevious);
+}
+
+void FGH_VerletRope::Step(const FGH_VerletRopeSettings& Settings, float StepSeconds, const FGH_SwingVector& Start, const FGH_SwingVector& End)
+{
+	const std::size_t NumPoints = Positions.size();
+	const FGH_SwingVector GravityOffset(0.f, 0.f, -Settings.Gravity * StepSeconds * StepSeconds);
+	const float Retain = 1.f - Settings.Damping;
+
+	for (std::size_t Point = 1; Point + 1 < NumPoints; ++Point)
+	{
+		const FGH_SwingVector Velocity = (Positions[Point] - PreviousPositions[Point]) * Retain;
+		PreviousPositions[Point] = Positions[Point];
+		Positions[Point] = Positions[Point] + Velocity + GravityOffset;
+	}
+
+	PreviousPositions.front() = Positions.front();
+	PreviousPositions.back() = Positions.back();
+	Positions.front() = Start;
+	Positions.back() = End;
+
+	SolveConstraints(Settings.Iterations);
+}
+
+void FGH_VerletRope::SolveConstraints(int32_t Iterations)
+{
+	const std::size_t NumPoints = Positions.size();
+	const float SegmentLength = RestLength / (NumPoints - 1);
+
+	for (int32_t Iteration = 0; Iteration < Iterations; ++Iteration)
+	{
+		for (std::size_t Point = 0; Point + 1 < NumPoints; ++Point)
+		{
+			const FGH_SwingVector Delta = Positions[Point + 1] - Positions[Point];
+			const float Length = Delta.Size();
+			if (Length <= 1.e-4f)
+			{
+				continue;
+			}
+
+			const FGH_SwingVector Correction = Delta * ((Length - SegmentLength) / Length);
+
+			// Pinned ends have an infinite mass, the free particle takes the whole correction
+			const bool bStartPinned = Point == 0;
+			const bool bEndPinned = Point + 2 == NumPoints;
+			if (bStartPinned && bEndPinned)
+			{
+				continue;
+			}
+			else if (bStartPinned)
+			{
+				Positions[Point + 1] = Positions[Point + 1] - Correction;
+			}
+			else if (bEndPinned)
+			{
+				Positions[Point] = Positions[Point] + Correction;
+			}
+			else
+			{
+				Positions[Point] = Positions[Point] + Correction * 0.5f;
+				Positions[Point + 1] = Positions[Point + 1] - Correction * 0.5f;
+			}
+		}
+	}
+}
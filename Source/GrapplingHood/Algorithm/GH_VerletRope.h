@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Segmented rope simulated with Verlet particles and distance constraints, free of any engine dependency.
+
+#include "GH_Pendulum.h"
+
+#include <cstddef>
+#include <vector>
+
+/** Solver configuration of a segmented rope */
+struct FGH_VerletRopeSettings
+{
+	/** Gravity acceleration (positive, in cm/s^2) */
+	float Gravity = 980.f;
+	/** Fraction of the particle velocity lost at each step */
+	float Damping = 0.02f;
+	/** Number of constraint relaxation passes per step */
+	int32_t Iterations = 4;
+};
+
+/** Rope pinned at both ends, the particles are stored contiguously from start to end */
+class FGH_VerletRope
+{
+public:
+	/** Lays NumSegments straight segments between the two ends */
+	void Reset(int32_t NumSegments, const FGH_SwingVector& Start, const FGH_SwingVector& End);
+
+	/** Changes the segment count keeping the current shape and velocity of the rope */
+	void Resample(int32_t NumSegments);
+
+	/** Length of the rope at rest, shorter than the ends distance means stretched, longer means slack */
+	void SetRestLength(float InRestLength) { RestLength = InRestLength; }
+
+	/** Advances the particles by one step with the ends pinned at the given locations */
+	void Step(const FGH_VerletRopeSettings& Settings, float StepSeconds, const FGH_SwingVector& Start, const FGH_SwingVector& End);
+
+	int32_t GetNumSegments() const { return static_cast<int32_t>(Positions.size()) - 1; }
+	int32_t GetNumPoints() const { return static_cast<int32_t>(Positions.size()); }
+	const FGH_SwingVector* GetPoints() const { return Positions.data(); }
+	/** Points at the previous step, the particle velocities are the difference with GetPoints */
+	const FGH_SwingVector* GetPreviousPoints() const { return PreviousPositions.data(); }
+	float GetRestLength() const { return RestLength; }
+
+private:
+	/** Moves the particles toward the segment rest length, the pinned ends never move */
+	void SolveConstraints(int32_t Iterations);
+
+	std::vector<FGH_SwingVector> Positions;
+	std::vector<FGH_SwingVector> PreviousPositions;
+	float RestLength = 0.f;
+};
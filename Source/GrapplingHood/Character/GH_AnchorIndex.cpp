@@ -0,0 +1,208 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GH_AnchorIndex.h"
+#include "GH_AnchorPointComponent.h"
+#include "GrapplingHood.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+
+DECLARE_CYCLE_STAT(TEXT("Anchor query"), STAT_GH_AnchorQuery, STATGROUP_Grappling);
+DECLARE_CYCLE_STAT(TEXT("Swing path"), STAT_GH_SwingPath, STATGROUP_Grappling);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Swing paths planned"), STAT_GH_SwingPathsPlanned, STATGROUP_Grappling);
+
+static_assert(sizeof(FVector) == sizeof(FGH_SwingVector), "The anchor arrays are shared with the grid");
+
+/** Length cut from both ends of the swing link traces (in cm) */
+static const float GSwingLinkTraceMargin = 20.f;
+
+// Sets default values
+AGH_AnchorIndex::AGH_AnchorIndex()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+	RootComponent->Mobility = EComponentMobility::Static;
+}
+
+AGH_AnchorIndex* AGH_AnchorIndex::Get(UWorld* World)
+{
+	if (World == nullptr)
+	{
+		return nullptr;
+	}
+
+	for (TActorIterator<AGH_AnchorIndex> It(World); It; ++It)
+	{
+		return *It;
+	}
+
+	return nullptr;
+}
+
+void AGH_AnchorIndex::RebuildIndex()
+{
+	Modify();
+	BuildIndex();
+}
+
+void AGH_AnchorIndex::BuildIndex()
+{
+	TArray<FVector> Anchors;
+
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+	{
+		AActor* Actor = *It;
+
+		TInlineComponentArray<UGH_AnchorPointComponent*> AnchorPoints(Actor);
+		for (const UGH_AnchorPointComponent* AnchorPoint : AnchorPoints)
+		{
+			Anchors.Add(AnchorPoint->GetComponentLocation());
+		}
+
+		if (!AutoAnchorTag.IsNone() && Actor->ActorHasTag(AutoAnchorTag))
+		{
+			const FBox Bounds = Actor->GetComponentsBoundingBox();
+			if (Bounds.IsValid)
+			{
+				Anchors.Add(FVector(Bounds.Min.X, Bounds.Min.Y, Bounds.Max.Z));
+				Anchors.Add(FVector(Bounds.Min.X, Bounds.Max.Y, Bounds.Max.Z));
+				Anchors.Add(FVector(Bounds.Max.X, Bounds.Min.Y, Bounds.Max.Z));
+				Anchors.Add(FVector(Bounds.Max.X, Bounds.Max.Y, Bounds.Max.Z));
+			}
+		}
+	}
+
+	Grid.Build(reinterpret_cast<const FGH_SwingVector*>(Anchors.GetData()), Anchors.Num(), CellSize);
+
+	const std::vector<FGH_SwingVector>& SortedAnchors = Grid.GetAnchors();
+	AnchorLocations.SetNumUninitialized(SortedAnchors.size());
+	FMemory::Memcpy(AnchorLocations.GetData(), SortedAnchors.data(), SortedAnchors.size() * sizeof(FVector));
+
+	const std::vector<int64_t>& Keys = Grid.GetCellKeys();
+	CellKeys.SetNumUninitialized(Keys.size());
+	FMemory::Memcpy(CellKeys.GetData(), Keys.data(), Keys.size() * sizeof(int64));
+
+	const std::vector<int32_t>& Starts = Grid.GetCellStarts();
+	CellStarts.SetNumUninitialized(Starts.size());
+	FMemory::Memcpy(CellStarts.GetData(), Starts.data(), Starts.size() * sizeof(int32));
+
+	BuiltCellSize = CellSize;
+	BuildSwingGraph();
+}
+
+void AGH_AnchorIndex::BuildSwingGraph()
+{
+	FGH_SwingLinkSettings Settings;
+	Settings.MaxDistance = MaxLinkDistance;
+	Settings.MinDistance = MinLinkDistance;
+	Settings.MaxClimb = MaxLinkClimb;
+	Settings.MaxDrop = MaxLinkDrop;
+	Settings.MaxLinksPerAnchor = MaxLinksPerAnchor;
+
+	// Loaded levels saved before the graph existed have no physics scene yet, their links are traced on the next save
+	UWorld* const World = GetWorld();
+	FGH_SwingLinkFilter LineOfSight;
+	if (bTraceSwingLinks && World != nullptr && World->GetPhysicsScene() != nullptr)
+	{
+		const TArray<FVector>& Anchors = AnchorLocations;
+		const FCollisionQueryParams Params(SCENE_QUERY_STAT(SwingLinkTrace), false);
+		const ECollisionChannel Channel = SwingLinkChannel;
+		LineOfSight = [World, &Anchors, &Params, Channel](int32_t From, int32_t To)
+		{
+			// Anchors sit on the surface of the level, the ends of the trace are pulled in so it does not hit it
+			const FVector Start = Anchors[From];
+			const FVector End = Anchors[To];
+			const FVector Margin = (End - Start).GetSafeNormal() * GSwingLinkTraceMargin;
+			return !World->LineTraceTestByChannel(Start + Margin, End - Margin, Channel, Params);
+		};
+	}
+	SwingGraph.Build(Grid, Settings, LineOfSight);
+
+	const std::vector<int32_t>& LinkStarts = SwingGraph.GetLinkStarts();
+	SwingLinkStarts.SetNumUninitialized(LinkStarts.size());
+	FMemory::Memcpy(SwingLinkStarts.GetData(), LinkStarts.data(), LinkStarts.size() * sizeof(int32));
+
+	const std::vector<int32_t>& Links = SwingGraph.GetLinks();
+	SwingLinks.SetNumUninitialized(Links.size());
+	FMemory::Memcpy(SwingLinks.GetData(), Links.data(), Links.size() * sizeof(int32));
+}
+
+void AGH_AnchorIndex::LoadGrid()
+{
+	// Saved before any anchor was gathered
+	if (CellStarts.Num() != CellKeys.Num() + 1)
+	{
+		Grid.Build(nullptr, 0, BuiltCellSize);
+		return;
+	}
+
+	Grid.Assign(reinterpret_cast<const FGH_SwingVector*>(AnchorLocations.GetData()), AnchorLocations.Num(), CellKeys.GetData(), CellStarts.GetData(), CellKeys.Num(), BuiltCellSize);
+
+	// Levels saved before the swing graph existed build it once here
+	if (SwingLinkStarts.Num() != AnchorLocations.Num() + 1)
+	{
+		BuildSwingGraph();
+		return;
+	}
+
+	SwingGraph.Assign(SwingLinkStarts.GetData(), AnchorLocations.Num(), SwingLinks.GetData(), SwingLinks.Num());
+}
+
+void AGH_AnchorIndex::PostLoad()
+{
+	Super::PostLoad();
+
+	LoadGrid();
+}
+
+#if WITH_EDITOR
+void AGH_AnchorIndex::PreSave(const class ITargetPlatform* TargetPlatform)
+{
+	Super::PreSave(TargetPlatform);
+
+	// Also runs when cooking, the cooked level always holds an up to date index. The package is being saved, no Modify
+	if (GetWorld() != nullptr)
+	{
+		BuildIndex();
+	}
+}
+#endif
+
+bool AGH_AnchorIndex::FindAnchor(const FVector& Origin, const FVector& Direction, float HalfAngle, float MaxDistance, FVector& OutLocation) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_GH_AnchorQuery);
+
+	const FVector Axis = Direction.GetSafeNormal();
+	const int32 Anchor = Grid.FindNearestInCone(FGH_SwingVector(Origin.X, Origin.Y, Origin.Z), FGH_SwingVector(Axis.X, Axis.Y, Axis.Z), FMath::Cos(FMath::DegreesToRadians(HalfAngle)), MaxDistance);
+	if (Anchor == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const FGH_SwingVector& Location = Grid.GetAnchors()[Anchor];
+	OutLocation = FVector(Location.X, Location.Y, Location.Z);
+	return true;
+}
+
+int32 AGH_AnchorIndex::FindNearestAnchor(const FVector& Location, float MaxDistance) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_GH_AnchorQuery);
+
+	return Grid.FindNearestInCone(FGH_SwingVector(Location.X, Location.Y, Location.Z), FGH_SwingVector(0.f, 0.f, 1.f), -1.f, MaxDistance);
+}
+
+bool AGH_AnchorIndex::FindSwingPath(int32 Start, int32 Goal, TArray<int32>& OutPath) const
+{
+	GH_SCOPE_CYCLE_COUNTER(SwingPath);
+	INC_DWORD_STAT(STAT_GH_SwingPathsPlanned);
+	check(IsInGameThread());
+
+	OutPath.Reset();
+	if (!SwingGraph.FindPath(Grid, Start, Goal, MaxPathExpansions, PathSearch, PathAnchors))
+	{
+		return false;
+	}
+
+	OutPath.Append(PathAnchors.data(), PathAnchors.size());
+	return true;
+}
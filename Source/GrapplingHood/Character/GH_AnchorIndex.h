@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Algorithm/GH_AnchorGrid.h"
+#include "Algorithm/GH_SwingGraph.h"
+#include "GH_AnchorIndex.generated.h"
+
+/**
+ * Spatial index of the grapple anchors of a level, placed once per level.
+ * Built in the editor from the UGH_AnchorPointComponent of the level and the anchors generated on the tagged actors,
+ * and saved with the level so it is only loaded at runtime.
+ * Also holds the swing graph linking the anchors reachable from each other, used by the bots to plan their route.
+ * The graph only holds swings, it is not joined to the navigation mesh: a bot reaches its first anchor and leaves
+ * the last one by its own navigation.
+ */
+UCLASS()
+class GRAPPLINGHOOD_API AGH_AnchorIndex : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	AGH_AnchorIndex();
+
+	/** Returns the anchor index placed in the world, null if the level has none */
+	static AGH_AnchorIndex* Get(UWorld* World);
+
+	/** Edge of the index cells (in cm), about the usual query range divided by 4 */
+	UPROPERTY(EditAnywhere, Category = Anchors, meta = (ClampMin = "100"))
+	float CellSize = 1000.f;
+
+	/** Actors with this tag get anchors generated on the top corners of their bounds */
+	UPROPERTY(EditAnywhere, Category = Anchors)
+	FName AutoAnchorTag = TEXT("GrappleAnchor");
+
+	/** Farthest anchor linked to another in the swing graph (in cm) */
+	UPROPERTY(EditAnywhere, Category = "Anchors|Swing Graph", meta = (ClampMin = "0"))
+	float MaxLinkDistance = 3000.f;
+
+	/** Closest anchor linked to another in the swing graph (in cm) */
+	UPROPERTY(EditAnywhere, Category = "Anchors|Swing Graph", meta = (ClampMin = "0"))
+	float MinLinkDistance = 300.f;
+
+	/** Highest a linked anchor can be above the one swung from (in cm) */
+	UPROPERTY(EditAnywhere, Category = "Anchors|Swing Graph", meta = (ClampMin = "0"))
+	float MaxLinkClimb = 300.f;
+
+	/** Lowest a linked anchor can be below the one swung from (in cm) */
+	UPROPERTY(EditAnywhere, Category = "Anchors|Swing Graph", meta = (ClampMin = "0"))
+	float MaxLinkDrop = 2000.f;
+
+	/** Links kept per anchor, the closest ones */
+	UPROPERTY(EditAnywhere, Category = "Anchors|Swing Graph", meta = (ClampMin = "1"))
+	int32 MaxLinksPerAnchor = 16;
+
+	/** Drops the swing links blocked by the level, traced on SwingLinkChannel when the index is built in the editor */
+	UPROPERTY(EditAnywhere, Category = "Anchors|Swing Graph")
+	bool bTraceSwingLinks = true;
+
+	/** Channel of the traces checking the swing links */
+	UPROPERTY(EditAnywhere, Category = "Anchors|Swing Graph", meta = (EditCondition = "bTraceSwingLinks"))
+	TEnumAsByte<ECollisionChannel> SwingLinkChannel = ECC_Visibility;
+
+	/** Anchors visited by a path search before it gives up */
+	UPROPERTY(EditAnywhere, Category = "Anchors|Swing Graph", meta = (ClampMin = "1"))
+	int32 MaxPathExpansions = 4096;
+
+	/** Gathers the anchors of the level and rebuilds the index, done automatically when the level is saved */
+	UFUNCTION(CallInEditor, Category = Anchors)
+	void RebuildIndex();
+
+	/**
+	 * Finds the closest anchor within MaxDistance of Origin and less than HalfAngle degrees away from Direction.
+	 * @return false if no anchor is in the cone
+	 */
+	bool FindAnchor(const FVector& Origin, const FVector& Direction, float HalfAngle, float MaxDistance, FVector& OutLocation) const;
+
+	/** Returns the index of the anchor closest to Location within MaxDistance, INDEX_NONE if none */
+	int32 FindNearestAnchor(const FVector& Location, float MaxDistance) const;
+
+	/**
+	 * Plans the swings leading from the Start anchor to the Goal anchor.
+	 * Searches share the index working memory, call from the game thread only.
+	 * @return false if the goal cannot be reached, else OutPath holds the anchor indices from Start to Goal
+	 */
+	bool FindSwingPath(int32 Start, int32 Goal, TArray<int32>& OutPath) const;
+
+	FORCEINLINE FVector GetAnchorLocation(int32 Anchor) const { return AnchorLocations[Anchor]; }
+	FORCEINLINE int32 GetNumAnchors() const { return AnchorLocations.Num(); }
+	FORCEINLINE int32 GetNumSwingLinks() const { return SwingLinks.Num(); }
+
+	virtual void PostLoad() override;
+#if WITH_EDITOR
+	virtual void PreSave(const class ITargetPlatform* TargetPlatform) override;
+#endif
+
+protected:
+	/** Copies the saved arrays into the runtime grid and swing graph */
+	void LoadGrid();
+
+	/** Gathers the anchors of the level and builds the grid and the swing graph, without marking the level dirty */
+	void BuildIndex();
+
+	/** Links the anchors of the grid and copies the graph to the saved arrays */
+	void BuildSwingGraph();
+
+	// Index saved with the level, anchors sorted by cell
+	UPROPERTY()
+	TArray<FVector> AnchorLocations;
+	UPROPERTY()
+	TArray<int64> CellKeys;
+	UPROPERTY()
+	TArray<int32> CellStarts;
+	UPROPERTY()
+	float BuiltCellSize = 1000.f;
+
+	// Swing graph saved with the level, links of each anchor sorted by distance
+	UPROPERTY()
+	TArray<int32> SwingLinkStarts;
+	UPROPERTY()
+	TArray<int32> SwingLinks;
+
+	FGH_AnchorGrid Grid;
+	FGH_SwingGraph SwingGraph;
+
+	/** Working memory of FindSwingPath */
+	mutable FGH_SwingGraphSearch PathSearch;
+	mutable std::vector<int32_t> PathAnchors;
+};
@@ -0,0 +1,10 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GH_AnchorPointComponent.h"
+
+// Sets default values for this component's properties
+UGH_AnchorPointComponent::UGH_AnchorPointComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	Mobility = EComponentMobility::Static;
+}
@@ -0,0 +1,18 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SceneComponent.h"
+#include "GH_AnchorPointComponent.generated.h"
+
+/** Designer placed grapple anchor, gathered into the level AGH_AnchorIndex when it is rebuilt */
+UCLASS(ClassGroup = (Grappling), meta = (BlueprintSpawnableComponent))
+class GRAPPLINGHOOD_API UGH_AnchorPointComponent : public USceneComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	UGH_AnchorPointComponent();
+};
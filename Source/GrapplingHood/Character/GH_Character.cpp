@@ -1,6 +1,14 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "GH_Character.h"
+#include "GrapplingHood.h"
+#include "GH_SwingManager.h"
+#include "GH_RopeComponent.h"
+#include "GH_HookTargeting.h"
+#include "GH_AnchorIndex.h"
+#include "GH_SwingReplication.h"
+#include "GH_CharacterMovementComponent.h"
+#include "GH_ReplayRecorder.h"
 
 #include "Animation/AnimInstance.h"
 #include "Camera/CameraComponent.h"
@@ -9,23 +17,37 @@
 #include "Kismet/GameplayStatics.h"
 #include "Components/SkinnedMeshComponent.h"
 #include "UObject/ConstructorHelpers.h"
-#include "Engine/StaticMeshActor.h"
-#include "Components/StaticMeshComponent.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "Engine/Public/Engine.h"
+#include "GameFramework/PlayerState.h"
+#include "Net/UnrealNetwork.h"
 #include "Containers/UnrealString.h"
-#include "Engine/Classes/PhysicsEngine/PhysicsConstraintComponent.h"
 #include <GenericPlatformMath.h>
 
 DEFINE_LOG_CATEGORY_STATIC(LogFPChar, Warning, All);
 
+DECLARE_CYCLE_STAT(TEXT("Character tick"), STAT_GH_CharacterTick, STATGROUP_Grappling);
+DECLARE_CYCLE_STAT(TEXT("Update rope"), STAT_GH_UpdateRope, STATGROUP_Grappling);
+DECLARE_CYCLE_STAT(TEXT("Lock rope"), STAT_GH_LockRope, STATGROUP_Grappling);
+DECLARE_CYCLE_STAT(TEXT("Unlock rope"), STAT_GH_UnlockRope, STATGROUP_Grappling);
+DECLARE_CYCLE_STAT(TEXT("Apply swing"), STAT_GH_ApplySwing, STATGROUP_Grappling);
+DECLARE_CYCLE_STAT(TEXT("Rope wrap"), STAT_GH_RopeWrap, STATGROUP_Grappling);
+DECLARE_CYCLE_STAT(TEXT("Follow rope anchors"), STAT_GH_FollowRopeAnchors, STATGROUP_Grappling);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Rope wrap traces"), STAT_GH_RopeWrapTraces, STATGROUP_Grappling);
+
+/** Distance (in cm) under which a local wrap point is the same as the server one */
+static const float GRopeWrapMatchDistance = 10.f;
+
 //////////////////////////////////////////////////////////////////////////
 // AGH_Character
 
 // Sets default values
-AGH_Character::AGH_Character()
+AGH_Character::AGH_Character(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UGH_CharacterMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
-	SetActorTickEnabled(true);
+	// Only ticks while the hook is active, see UpdateTickEnabled
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
 
 	// Set size for collision capsule
 	GetCapsuleComponent()->InitCapsuleSize(55.f, 96.0f);
@@ -61,7 +83,7 @@ AGH_Character::AGH_Character()
 	MuzzleLocation->SetupAttachment(GunMesh);
 	MuzzleLocation->SetRelativeLocation(FVector(0.2f, 48.4f, -10.6f));
 
-	RopeMesh = ConstructorHelpers::FObjectFinder<UStaticMesh>(TEXT("/Engine/BasicShapes/Cylinder")).Object;
+	Rope = CreateDefaultSubobject<UGH_RopeComponent>(TEXT("Rope"));
 
 	// Default offset from the character location for projectiles to spawn
 	GunOffset = FVector(100.0f, 0.0f, 10.0f);
@@ -75,47 +97,103 @@ void AGH_Character::BeginPlay()
 
 	//Attach gun mesh component to Skeleton, doing it here because the skeleton is not yet created in the constructor
 	GunMesh->AttachToComponent(BodyMesh, FAttachmentTransformRules(EAttachmentRule::SnapToTarget, true), TEXT("GripPoint"));
+	Muzzle.Resolve(GunMesh, TEXT("Muzzle"));
 
 	// Create hook tip
 	if (HookClass != NULL)
 	{
-		UWorld* const World = GetWorld();
-		if (World != NULL)
+		ActorPool = AGH_ActorPool::Get(GetWorld());
+		if (ActorPool != NULL)
 		{
 			const FRotator SpawnRotation = GetControlRotation();
 			// MuzzleOffset is in camera space, so transform it to world space before offsetting from the character location to find the final muzzle position
 			const FVector SpawnLocation = ((MuzzleLocation != nullptr) ? MuzzleLocation->GetComponentLocation() : GetActorLocation()) + SpawnRotation.RotateVector(GunOffset);
 
-			//Set Spawn Collision Handling Override
-			FActorSpawnParameters ActorSpawnParams;
-			ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
+			ActorPool->Prewarm(HookClass);
+
+			const int32 HookCount = FMath::Clamp(NumHooks, 1, GH_MAX_ROPES_PER_BODY);
+			for (int32 HookIndex = 0; HookIndex < HookCount; ++HookIndex)
+			{
+				// take a hook from the pool at the muzzle, respawning characters reuse the hooks of the dead ones
+				AGH_Hook* NewHook = ActorPool->Acquire<AGH_Hook>(HookClass, FTransform(SpawnRotation, SpawnLocation), this, this);
+				check(NewHook != nullptr && "Spawning of Hook class failed");
+				NewHook->StopAllMovement();
+				NewHook->AttachToComponent(GunMesh, FAttachmentTransformRules::SnapToTargetNotIncludingScale, "Muzzle");
+				NewHook->OnStateChanged().AddUObject(this, &AGH_Character::OnHookStateChanged);
+				Hooks.Add(NewHook);
+
+				// The extra hooks get a copy of the primary rope
+				UGH_RopeComponent* HookRope = Rope;
+				if (HookIndex > 0)
+				{
+					HookRope = NewObject<UGH_RopeComponent>(this, Rope->GetClass(), NAME_None, RF_Transient, Rope);
+					HookRope->RegisterComponent();
+				}
+				Ropes.Add(HookRope);
+			}
 
-			// spawn the projectile at the muzzle
-			HookInstance = World->SpawnActor<AGH_Hook>(HookClass, SpawnLocation, SpawnRotation, ActorSpawnParams);
-			check(HookInstance != nullptr && "Spawning of Hook class failed");
-			HookInstance->StopAllMovement();
-			HookInstance->AttachToComponent(GunMesh, FAttachmentTransformRules::SnapToTargetNotIncludingScale, "Muzzle");
+			HookInstance = Hooks[0];
+			HookRopeLengths.SetNumZeroed(HookCount);
+			if (HasAuthority())
+			{
+				ReplicatedSecondaryHooks.SetNum(HookCount - 1);
+			}
 		}
 	}
 
-	// create rope mesh
-	UWorld* const World = GetWorld();
-	if (World != NULL)
+	SwingManager = AGH_SwingManager::Get(GetWorld());
+	if (SwingManager != nullptr)
+	{
+		// Swing moves go to the location computed by the manager this frame
+		GetCharacterMovement()->AddTickPrerequisiteActor(SwingManager);
+	}
+	AnchorIndex = AGH_AnchorIndex::Get(GetWorld());
+
+	HookTargeting = AGH_HookTargeting::Get(GetWorld());
+	if (HookTargeting != nullptr)
+	{
+		HookTargeting->RegisterCharacter(this);
+	}
+}
+
+void AGH_Character::PawnClientRestart()
+{
+	Super::PawnClientRestart();
+
+	// Only the characters of the local players are recorded
+	ReplayRecorder = AGH_ReplayRecorder::Get(GetWorld());
+	if (ReplayRecorder != nullptr)
+	{
+		ReplayRecorder->RegisterCharacter(this);
+	}
+}
+
+void AGH_Character::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (RopeLocked)
 	{
-		// spawn the projectile at the muzzle
-		Rope = World->SpawnActor<AStaticMeshActor>();
-		Rope->SetMobility(EComponentMobility::Movable);
-		Rope->SetActorEnableCollision(false);
-		Rope->FindComponentByClass<UStaticMeshComponent>()->SetStaticMesh(RopeMesh);
-		Rope->FindComponentByClass<UStaticMeshComponent>()->SetVisibility(false);
-		Rope->SetActorLocation(FVector::ZeroVector);
+		UnlockRope();
+	}
 
-		PhysicsConstraints.SetNum(2);
+	if (HookTargeting != nullptr)
+	{
+		HookTargeting->UnregisterCharacter(this);
+	}
 
-		// spawn the physics constraints
-		PhysicsConstraints[0] = World->SpawnActor<APhysicsConstraintActor>();
-		PhysicsConstraints[1] = World->SpawnActor<APhysicsConstraintActor>();
+	if (ActorPool != nullptr)
+	{
+		for (AGH_Hook* CharacterHook : Hooks)
+		{
+			CharacterHook->OnStateChanged().RemoveAll(this);
+			ActorPool->Release(CharacterHook);
+		}
 	}
+	Hooks.Reset();
+	HookInstance = nullptr;
+
+	Muzzle.Reset();
+
+	Super::EndPlay(EndPlayReason);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -127,11 +205,12 @@ void AGH_Character::SetupPlayerInputComponent(class UInputComponent* PlayerInput
 	check(PlayerInputComponent);
 
 	// Bind jump events
-	PlayerInputComponent->BindAction("Jump", IE_Pressed, this, &ACharacter::Jump);
-	PlayerInputComponent->BindAction("Jump", IE_Released, this, &ACharacter::StopJumping);
+	PlayerInputComponent->BindAction("Jump", IE_Pressed, this, &AGH_Character::OnJumpPressed);
+	PlayerInputComponent->BindAction("Jump", IE_Released, this, &AGH_Character::OnJumpReleased);
 
 	// Bind fire event
 	PlayerInputComponent->BindAction("Fire", IE_Pressed, this, &AGH_Character::OnFire);
+	PlayerInputComponent->BindAction("FireSecondary", IE_Pressed, this, &AGH_Character::OnFireSecondary);
 
 	// Bind movement events
 	PlayerInputComponent->BindAxis("MoveForward", this, &AGH_Character::MoveForward);
@@ -140,161 +219,1151 @@ void AGH_Character::SetupPlayerInputComponent(class UInputComponent* PlayerInput
 	// We have 2 versions of the rotation bindings to handle different kinds of devices differently
 	// "turn" handles devices that provide an absolute delta, such as a mouse.
 	// "turnrate" is for devices that we choose to treat as a rate of change, such as an analog joystick
-	PlayerInputComponent->BindAxis("Turn", this, &APawn::AddControllerYawInput);
+	PlayerInputComponent->BindAxis("Turn", this, &AGH_Character::Turn);
 	PlayerInputComponent->BindAxis("TurnRate", this, &AGH_Character::TurnAtRate);
-	PlayerInputComponent->BindAxis("LookUp", this, &APawn::AddControllerPitchInput);
+	PlayerInputComponent->BindAxis("LookUp", this, &AGH_Character::LookUp);
 	PlayerInputComponent->BindAxis("LookUpRate", this, &AGH_Character::LookUpAtRate);
+	PlayerInputComponent->BindAxis("Reel", this, &AGH_Character::Reel);
 }
 
 void AGH_Character::Tick(float DeltaSeconds)
 {
-	if ((!RopeLocked && HookInstance->GetState() == AGH_Hook::State::HOOKED) || HookInstance->GetState() == AGH_Hook::State::RETRACTING || HookInstance->GetState() == AGH_Hook::State::FIRING)
-		UpdateRope();
+	GH_SCOPE_CYCLE_COUNTER(CharacterTick);
+	FGH_ScopedFrameCycles FrameCycles(FGH_FrameCounters::Get().CharacterTickCycles);
 
-	if (!RopeLocked && HookInstance->GetState() == AGH_Hook::State::HOOKED && GetCharacterMovement()->Velocity.Z < -10.f)
+	bool bCanLock = false;
+	for (int32 HookIndex = 0; HookIndex < Hooks.Num(); ++HookIndex)
+	{
+		switch (Hooks[HookIndex]->GetState())
+		{
+		case AGH_Hook::State::FIRING:
+			UpdateRope(HookIndex);
+			break;
+		case AGH_Hook::State::HOOKED:
+			if (!RopeLocked)
+			{
+				UpdateRope(HookIndex);
+				bCanLock = true;
+			}
+			break;
+		case AGH_Hook::State::RETRACTING:
+			UpdateRope(HookIndex);
+			Hooks[HookIndex]->Retract(GetMuzzleWorldLocation(), DeltaSeconds);
+			break;
+		default:
+			break;
+		}
+	}
+
+	// Simulated proxies lock when the server says so, see ReconcileSwing
+	if (bCanLock && Role != ROLE_SimulatedProxy && GetCharacterMovement()->Velocity.Z < -10.f)
 		LockRope();
 
-	if (RopeLocked)
+	//DrawDebugLine(GetWorld(), GetActorLocation(), GetActorLocation() + GetCharacterMovement()->Velocity, FColor::Red, false, -1.f, 0, 1.f);
+}
+
+void AGH_Character::OnHookStateChanged(AGH_Hook* ChangedHook, AGH_Hook::State PreviousState, AGH_Hook::State NewState)
+{
+	const int32 HookIndex = Hooks.IndexOfByKey(ChangedHook);
+	if (HookIndex == INDEX_NONE)
 	{
-		SwingCharacter(DeltaSeconds);
+		return;
 	}
 
-	if (HookInstance->GetState() == AGH_Hook::State::RETRACTING)
+	if (NewState == AGH_Hook::State::DOCKED)
 	{
-		HookInstance->Retract(GunMesh->GetSocketByName("Muzzle")->GetSocketLocation(GunMesh), DeltaSeconds);
-		if(HookInstance->GetState() == AGH_Hook::State::DOCKED)
-		{
-			HookInstance->AttachToComponent(GunMesh, FAttachmentTransformRules::SnapToTargetNotIncludingScale, "Muzzle");
-			Rope->SetActorLocation(FVector::ZeroVector);
-			Rope->FindComponentByClass<UStaticMeshComponent>()->SetVisibility(false);
-		}
+		ChangedHook->AttachToComponent(GunMesh, FAttachmentTransformRules::SnapToTargetNotIncludingScale, "Muzzle");
+		Ropes[HookIndex]->SetRopeVisibility(false);
 	}
 
-	//DrawDebugLine(GetWorld(), GetActorLocation(), GetActorLocation() + GetCharacterMovement()->Velocity, FColor::Red, false, -1.f, 0, 1.f);
+	if (HasAuthority() && (HookIndex == 0 || ReplicatedSecondaryHooks.IsValidIndex(HookIndex - 1)))
+	{
+		FGH_HookReplication& Replication = HookIndex == 0 ? ReplicatedHook : ReplicatedSecondaryHooks[HookIndex - 1];
+		Replication.State = NewState;
+		Replication.ShotId = LocalShotIds[HookIndex];
+		Replication.Anchor = ChangedHook->GetActorLocation();
+		Replication.AnchorComponent = ChangedHook->GetAnchorComponent();
+	}
+
+	// A rope joins or leaves the ones holding the character
+	if (RopeLocked && (NewState == AGH_Hook::State::HOOKED || PreviousState == AGH_Hook::State::HOOKED))
+	{
+		RefreshRopeHold();
+	}
+
+	UpdateTickEnabled();
+}
+
+void AGH_Character::UpdateTickEnabled()
+{
+	// The swing manager moves the character while the rope is locked
+	bool bTick = false;
+	for (const AGH_Hook* CharacterHook : Hooks)
+	{
+		const AGH_Hook::State HookState = CharacterHook->GetState();
+		bTick |= HookState == AGH_Hook::State::FIRING || HookState == AGH_Hook::State::RETRACTING || (HookState == AGH_Hook::State::HOOKED && !RopeLocked);
+	}
+	SetActorTickEnabled(bTick);
 }
 
 void AGH_Character::OnFire()
 {
+	if (ReplayRecorder != nullptr)
+	{
+		ReplayRecorder->RecordButton(GH_REPLAY_Fire);
+	}
+
 	if (HookInstance->GetState() == AGH_Hook::State::DOCKED)
 	{
-		HookInstance->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
-		HookInstance->Fire(Camera->GetForwardVector());
+		FireHookTowards(GetFireDirection());
+	}
+	else
+	{
+		ReleaseRopeAndHook();
+	}
+}
+
+void AGH_Character::OnFireSecondary()
+{
+	if (ReplayRecorder != nullptr)
+	{
+		ReplayRecorder->RecordButton(GH_REPLAY_FireSecondary);
+	}
 
-		// try and play the sound if specified
-		if (FireSound != NULL)
+	for (int32 HookIndex = 1; HookIndex < Hooks.Num(); ++HookIndex)
+	{
+		if (Hooks[HookIndex]->GetState() == AGH_Hook::State::DOCKED)
 		{
-			UGameplayStatics::PlaySoundAtLocation(this, FireSound, GetActorLocation());
+			FireHookTowards(GetFireDirection(), HookIndex);
+			return;
 		}
+	}
+
+	for (int32 HookIndex = 1; HookIndex < Hooks.Num(); ++HookIndex)
+	{
+		ReleaseRopeAndHook(HookIndex);
+	}
+}
+
+bool AGH_Character::FireHookTowards(const FVector& Direction, int32 HookIndex)
+{
+	if (!Hooks.IsValidIndex(HookIndex) || Hooks[HookIndex]->GetState() != AGH_Hook::State::DOCKED)
+	{
+		return false;
+	}
+
+	// Predicted, the server fires the same shot when it gets the request
+	++LocalShotIds[HookIndex];
+	FireHook(HookIndex, Direction);
+
+	if (Role < ROLE_Authority)
+	{
+		ServerFire(Direction, LocalShotIds[HookIndex], HookIndex);
+	}
+	return true;
+}
+
+void AGH_Character::ReleaseRopeAndHook(int32 HookIndex)
+{
+	if (!Hooks.IsValidIndex(HookIndex) || Hooks[HookIndex]->GetState() == AGH_Hook::State::DOCKED || Hooks[HookIndex]->GetState() == AGH_Hook::State::RETRACTING)
+	{
+		return;
+	}
+
+	ReleaseHook(HookIndex);
+
+	if (Role < ROLE_Authority)
+	{
+		ServerRelease(LocalShotIds[HookIndex], HookIndex);
+	}
+}
+
+void AGH_Character::ReleaseAllHooks()
+{
+	for (int32 HookIndex = 0; HookIndex < Hooks.Num(); ++HookIndex)
+	{
+		ReleaseRopeAndHook(HookIndex);
+	}
+}
+
+void AGH_Character::FireHook(int32 HookIndex, const FVector& Direction)
+{
+	if (HasAuthority() && (HookIndex == 0 || ReplicatedSecondaryHooks.IsValidIndex(HookIndex - 1)))
+	{
+		(HookIndex == 0 ? ReplicatedHook : ReplicatedSecondaryHooks[HookIndex - 1]).Direction = Direction;
+	}
+
+	Hooks[HookIndex]->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+	Hooks[HookIndex]->Fire(Direction);
+
+	// try and play the sound if specified
+	if (FireSound != NULL)
+	{
+		UGameplayStatics::PlaySoundAtLocation(this, FireSound, GetActorLocation());
+	}
 
-		// try and play a firing animation if specified
-		if (FireAnimation != NULL)
+	// try and play a firing animation if specified
+	if (FireAnimation != NULL)
+	{
+		// Get the animation object for the arms mesh
+		UAnimInstance* AnimInstance = BodyMesh->GetAnimInstance();
+		if (AnimInstance != NULL)
 		{
-			// Get the animation object for the arms mesh
-			UAnimInstance* AnimInstance = BodyMesh->GetAnimInstance();
-			if (AnimInstance != NULL)
-			{
-				AnimInstance->Montage_Play(FireAnimation, 1.f);
-			}
+			AnimInstance->Montage_Play(FireAnimation, 1.f);
 		}
+	}
+
+	Ropes[HookIndex]->SetRopeVisibility(true);
+}
 
-		Rope->FindComponentByClass<UStaticMeshComponent>()->SetVisibility(true);
+void AGH_Character::ReleaseHook(int32 HookIndex)
+{
+	// Leaving HOOKED drops the rope from the ones holding the character, see OnHookStateChanged
+	Hooks[HookIndex]->Retract(GetMuzzleWorldLocation(), 0.f);
+}
+
+bool AGH_Character::ServerFire_Validate(FVector_NetQuantizeNormal Direction, uint8 ShotId, uint8 HookIndex)
+{
+	return HookIndex < GH_MAX_ROPES_PER_BODY;
+}
+
+void AGH_Character::ServerFire_Implementation(FVector_NetQuantizeNormal Direction, uint8 ShotId, uint8 HookIndex)
+{
+	if (!Hooks.IsValidIndex(HookIndex))
+	{
+		return;
 	}
-	else if (HookInstance->GetState() != AGH_Hook::State::RETRACTING)
+
+	LocalShotIds[HookIndex] = ShotId;
+	if (Hooks[HookIndex]->GetState() == AGH_Hook::State::DOCKED)
 	{
-		UnlockRope();
-		HookInstance->Retract(GetMuzzleWorldLocation(), 0.f);
+		FireHook(HookIndex, Direction);
+	}
+}
+
+bool AGH_Character::ServerRelease_Validate(uint8 ShotId, uint8 HookIndex)
+{
+	return HookIndex < GH_MAX_ROPES_PER_BODY;
+}
+
+void AGH_Character::ServerRelease_Implementation(uint8 ShotId, uint8 HookIndex)
+{
+	// A release of an older shot arriving late
+	if (!Hooks.IsValidIndex(HookIndex) || ShotId != LocalShotIds[HookIndex])
+	{
+		return;
+	}
+
+	if (Hooks[HookIndex]->GetState() == AGH_Hook::State::FIRING || Hooks[HookIndex]->GetState() == AGH_Hook::State::HOOKED)
+	{
+		ReleaseHook(HookIndex);
 	}
 }
 
-void AGH_Character::UpdateRope()
+bool AGH_Character::ServerReel_Validate(int8 QuantizedInput)
+{
+	return true;
+}
+
+void AGH_Character::ServerReel_Implementation(int8 QuantizedInput)
 {
-	if (Rope != nullptr)
+	SetReelInput(QuantizedInput / 127.f);
+}
+
+void AGH_Character::SetReelInput(float Value)
+{
+	if (Value == ReelInput)
+	{
+		return;
+	}
+	ReelInput = Value;
+
+	if (Role < ROLE_Authority && IsLocallyControlled())
 	{
-		FVector CharLocation = GetMuzzleWorldLocation();
-		FVector HookLocation = HookInstance->GetActorLocation();
-		FVector CharToHookVector = HookLocation - CharLocation;
+		ServerReel(static_cast<int8>(FMath::RoundToInt(FMath::Clamp(Value, -1.f, 1.f) * 127.f)));
+	}
+
+	ApplyReelInput();
+}
 
-		Rope->SetActorLocation(CharLocation + (CharToHookVector / 2));
+void AGH_Character::ApplyReelInput()
+{
+	// Multi-rope holds keep their lengths
+	if (SwingRopeIndex != INDEX_NONE)
+	{
+		SwingManager->SetRopeReelSpeed(SwingRopeIndex, -ReelInput * ReelSpeed);
+	}
+}
 
-		Rope->SetActorRotation(FRotationMatrix::MakeFromZ(CharToHookVector).Rotator());
+void AGH_Character::OnRep_ReplicatedHook()
+{
+	ApplyReplicatedHook(0, ReplicatedHook);
+}
 
-		Rope->SetActorScale3D(FVector(0.04f, 0.04f, CharToHookVector.Size() / 100.f));
+void AGH_Character::OnRep_ReplicatedSecondaryHooks()
+{
+	for (int32 Index = 0; Index < ReplicatedSecondaryHooks.Num(); ++Index)
+	{
+		ApplyReplicatedHook(Index + 1, ReplicatedSecondaryHooks[Index]);
 	}
 }
 
-void AGH_Character::LockRope()
+void AGH_Character::ApplyReplicatedHook(int32 HookIndex, const FGH_HookReplication& Replication)
 {
-	UpdateRope();
+	if (!Hooks.IsValidIndex(HookIndex))
+	{
+		return;
+	}
 
-	FVector diffVec = HookInstance->GetActorLocation() - GetMuzzleWorldLocation();
-	SwingRopeLength = diffVec.Size();
-	SwingAngle = FMath::Acos(FVector::DotProduct(diffVec, FVector(0.f, 0.f, -1.f)) / SwingRopeLength);
-	SwingPlaneNormal = FVector::CrossProduct(FVector(0.f, 0.f, -1.f), diffVec);
-	SwingPlaneNormal.Normalize();
-	SwingZRotation = FMath::Acos(FVector::DotProduct(SwingPlaneNormal, FVector(0.f, 1.f, 0.f)));
-	float pouet = FMath::RadiansToDegrees(SwingZRotation);
-	RopeLocked = true;
+	// The owning client is ahead of the server, states from before its last shot are outdated
+	if (IsLocallyControlled() && Replication.ShotId != LocalShotIds[HookIndex])
+	{
+		return;
+	}
+
+	AGH_Hook* ReplicatedHookActor = Hooks[HookIndex];
+	const AGH_Hook::State LocalState = ReplicatedHookActor->GetState();
+	switch (Replication.State)
+	{
+	case AGH_Hook::State::FIRING:
+		if (LocalState == AGH_Hook::State::DOCKED)
+		{
+			FireHook(HookIndex, Replication.Direction);
+		}
+		break;
+	case AGH_Hook::State::HOOKED:
+		if (LocalState == AGH_Hook::State::DOCKED)
+		{
+			FireHook(HookIndex, Replication.Direction);
+		}
+		// The server decides where the hook attached
+		if (ReplicatedHookActor->GetState() == AGH_Hook::State::FIRING)
+		{
+			ReplicatedHookActor->HookAt(Replication.Anchor, Replication.AnchorComponent);
+		}
+		else if (ReplicatedHookActor->GetState() == AGH_Hook::State::HOOKED && !RopeLocked && !ReplicatedHookActor->IsOnMovingAnchor())
+		{
+			ReplicatedHookActor->SetActorLocation(Replication.Anchor);
+		}
+		break;
+	case AGH_Hook::State::RETRACTING:
+	case AGH_Hook::State::DOCKED:
+		if (LocalState == AGH_Hook::State::FIRING || LocalState == AGH_Hook::State::HOOKED)
+		{
+			ReleaseHook(HookIndex);
+		}
+		break;
+	default:
+		break;
+	}
 }
 
-#pragma optimize("", off)
-void AGH_Character::SwingCharacter(float DeltaSeconds)
+void AGH_Character::OnRep_ReplicatedSwing()
 {
-	FVector location = FVector::ZeroVector;
+	ReconcileSwing();
+}
+
+void AGH_Character::ReconcileSwing()
+{
+	// Several ropes are not replicated as a pendulum, the character follows the replicated movement
+	if (SwingManager == nullptr || HookInstance == nullptr || HookInstance->GetState() != AGH_Hook::State::HOOKED || RopeBodyIndex != INDEX_NONE)
+	{
+		return;
+	}
+
+	// A lock already released locally
+	const bool bNewLock = ReplicatedSwing.LockId != LockId;
+	if (!RopeLocked && !bNewLock)
+	{
+		return;
+	}
+
+	// The state swings around the last server wrap point, the wrap points come with it or in a later update
+	if (ReplicatedSwing.NumWraps != ReplicatedRopeWraps.Num())
+	{
+		return;
+	}
+
+	// The owning client wrapped ahead of the server, its swing is around a point the server has not reached yet
+	const int32 NumSameWraps = CountReplicatedRopeWraps();
+	if (RopeLocked && !bNewLock && IsLocallyControlled() && NumSameWraps == ReplicatedRopeWraps.Num() && NumSameWraps < RopeWraps.Num())
+	{
+		return;
+	}
+	LockId = ReplicatedSwing.LockId;
+
+	// The state left the server half a round trip ago, bring it to the present
+	const FGH_PendulumSettings Settings = SwingManager->GetSettings();
+	FGH_PendulumState ServerState = ReplicatedSwing.ToState();
+	const APlayerController* LocalController = GetWorld()->GetFirstPlayerController();
+	float Latency = (LocalController != nullptr && LocalController->PlayerState != nullptr) ? LocalController->PlayerState->ExactPing * 0.0005f : 0.f;
+	while (Latency > 0.f)
+	{
+		FGH_Pendulum::Step(ServerState, Settings, FMath::Min(Latency, Settings.FixedTimeStep));
+		Latency -= Settings.FixedTimeStep;
+	}
+
+	if (!RopeLocked)
+	{
+		LockRope(ServerState);
+		AdoptReplicatedRopeWraps();
+		return;
+	}
 
-    const float angleAccel = (-9.81f / SwingRopeLength) * FMath::Sin(SwingAngle);
-    SwingAngleVelocity += angleAccel * 80.f * DeltaSeconds;
-    SwingAngle -= SwingAngleVelocity * DeltaSeconds;
+	// Swinging around another pivot than the server, the local state cannot be blended
+	const bool bSameWraps = NumSameWraps == RopeWraps.Num() && NumSameWraps == ReplicatedRopeWraps.Num();
+	if (!bSameWraps)
+	{
+		AdoptReplicatedRopeWraps();
+	}
+
+	FGH_PendulumState LocalState = SwingManager->GetRopeState(SwingRopeIndex);
+	const float AngleError = FMath::FindDeltaAngleRadians(LocalState.Angle, ServerState.Angle);
+	const float PlaneError = FGH_SwingVector::Dot(LocalState.PlaneNormal, ServerState.PlaneNormal);
+
+	// Large errors snap to the server, small ones are blended in over the next updates
+	if (!bSameWraps || FMath::Abs(AngleError) > FMath::DegreesToRadians(SwingSnapAngle) || PlaneError < FMath::Cos(FMath::DegreesToRadians(SwingSnapAngle)))
+	{
+		SwingManager->SetRopeState(SwingRopeIndex, ServerState);
+		if (IsLocallyControlled())
+		{
+			ApplyReelInput();
+		}
+	}
+	else
+	{
+		// The owning client reels ahead of the server, it keeps its rope length while close enough
+		if (!IsLocallyControlled() || FMath::Abs(ServerState.RopeLength - LocalState.RopeLength) > ReelLengthTolerance)
+		{
+			LocalState.RopeLength = ServerState.RopeLength;
+		}
+		LocalState.Angle += AngleError * SwingCorrectionBlend;
+		LocalState.AngleVelocity += (ServerState.AngleVelocity - LocalState.AngleVelocity) * SwingCorrectionBlend;
+		SwingManager->SetRopeState(SwingRopeIndex, LocalState);
+	}
+}
+
+void AGH_Character::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	location.X += sin(SwingAngle) * SwingRopeLength;
-	location.Z += cos(SwingAngle) * SwingRopeLength;
+	DOREPLIFETIME(AGH_Character, ReplicatedHook);
+	DOREPLIFETIME(AGH_Character, ReplicatedSecondaryHooks);
+	DOREPLIFETIME(AGH_Character, ReplicatedSwing);
+	DOREPLIFETIME(AGH_Character, ReplicatedRopeWraps);
+}
 
-	float zDistance = location.X;
-	location.X += sin(SwingZRotation) * zDistance;
-	location.Y -= cos(SwingZRotation) * zDistance;
+FVector AGH_Character::GetFireDirection() const
+{
+	const FVector Aim = Camera->GetForwardVector();
 
-	location += HookInstance->GetActorLocation();
-	FVector newLocation = location - GetMuzzleLocalLocation();
-	SwingLastDelta = newLocation - GetMuzzleWorldLocation();
+	FVector AnchorLocation;
+	if (AnchorIndex != nullptr && AnchorAimAngle > 0.f && AnchorIndex->FindAnchor(Camera->GetComponentLocation(), Aim, AnchorAimAngle, AnchorAimRange, AnchorLocation))
+	{
+		return (AnchorLocation - HookInstance->GetActorLocation()).GetSafeNormal();
+	}
 
-	SetActorLocation(newLocation);
+	// The gun is off the camera, aim the hook at what the crosshair is over rather than parallel to the view
+	const FGH_HookTarget* Target = HookTargeting != nullptr ? HookTargeting->FindTarget(this) : nullptr;
+	if (Target != nullptr && Target->bValid)
+	{
+		const FVector HookToTarget = Target->Location - HookInstance->GetActorLocation();
+		if ((HookToTarget | Aim) > 0.f)
+		{
+			return HookToTarget.GetSafeNormal();
+		}
+	}
 
-	UpdateRope();
+	return Aim;
 }
-#pragma optimize("", on)
 
-void AGH_Character::UnlockRope()
+void AGH_Character::UpdateRope(int32 HookIndex)
 {
-	RopeLocked = false;
+	GH_SCOPE_CYCLE_COUNTER(UpdateRope);
 
-	GetCharacterMovement()->Velocity = GetTransform().Inverse().TransformVector(SwingLastDelta) * 10.f;
+	// The rope pays out while the hook travels and keeps its length once hooked
+	const bool bHooked = Hooks[HookIndex]->GetState() == AGH_Hook::State::HOOKED;
+	Ropes[HookIndex]->SetEndpoints(GetMuzzleWorldLocation(), Hooks[HookIndex]->GetActorLocation(), !bHooked ? EGH_RopeLength::PayOut : RopeLocked ? EGH_RopeLength::Taut : EGH_RopeLength::Fixed);
 }
 
-void AGH_Character::MoveForward(float Value)
+void AGH_Character::UpdateRopes()
 {
-	if (Value != 0.0f)
+	for (int32 HookIndex = 0; HookIndex < Hooks.Num(); ++HookIndex)
 	{
-		// add movement in that direction
-		AddMovementInput(GetActorForwardVector(), Value);
+		if (Hooks[HookIndex]->GetState() != AGH_Hook::State::DOCKED)
+		{
+			UpdateRope(HookIndex);
+		}
 	}
 }
 
-void AGH_Character::MoveRight(float Value)
+void AGH_Character::LockRope()
 {
-	if (Value != 0.0f)
+	RefreshRopeHold();
+}
+
+void AGH_Character::LockRope(const FGH_PendulumState& State)
+{
+	GH_SCOPE_CYCLE_COUNTER(LockRope);
+
+	// A new pendulum always hangs from the hook
+	ResetRopeWraps();
+
+	SwingRopeIndex = SwingManager->RegisterRope(this, State);
+	SwingMoveTime = 0.f;
+	HookRopeLengths[0] = State.RopeLength;
+
+	// A networked player swings move by move, on its client and on the server, so the saved moves hold the state they start from
+	SwingManager->SetRopeMoveDriven(SwingRopeIndex, Role == ROLE_AutonomousProxy || (HasAuthority() && GetRemoteRole() == ROLE_AutonomousProxy));
+
+	// A reel input held before the lock
+	if (Role == ROLE_Authority || IsLocallyControlled())
 	{
-		// add movement in that direction
-		AddMovementInput(GetActorRightVector(), Value);
+		ApplyReelInput();
+	}
+
+	// Tells the clients a new swing started, 0 is kept for no swing
+	if (HasAuthority())
+	{
+		LockId = LockId == MAX_uint8 ? 1 : LockId + 1;
+		ReplicatedSwing = FGH_SwingReplication::FromState(State, LockId, GetNumRopeWraps());
 	}
+
+	RopeLocked = true;
+	GetCharacterMovement()->SetMovementMode(MOVE_Custom, (uint8)EGH_CustomMovementMode::Swinging);
+	UpdateAnchorFollowing();
+	UpdateRopes();
+	UpdateTickEnabled();
 }
 
-void AGH_Character::TurnAtRate(float Rate)
+void AGH_Character::LockRopeBody(const FVector& Velocity)
 {
-	// calculate delta for this frame from the rate information
-	AddControllerYawInput(Rate * BaseTurnRate * GetWorld()->GetDeltaSeconds());
+	GH_SCOPE_CYCLE_COUNTER(LockRope);
+
+	RopeBodyIndex = SwingManager->RegisterBody(this, GetMuzzleWorldLocation(), Velocity);
+
+	RopeLocked = true;
+	GetCharacterMovement()->SetMovementMode(MOVE_Custom, (uint8)EGH_CustomMovementMode::Swinging);
+	UpdateRopes();
+	UpdateTickEnabled();
 }
 
-void AGH_Character::LookUpAtRate(float Rate)
+void AGH_Character::RefreshRopeHold()
 {
-	// calculate delta for this frame from the rate information
-	AddControllerPitchInput(Rate * BaseLookUpRate * GetWorld()->GetDeltaSeconds());
-}
\ No newline at end of file
+	const FVector MuzzleWorldLocation = GetMuzzleWorldLocation();
+
+	// The pendulum rope may have been reeled since the lock, and runs through its wrap points
+	if (SwingRopeIndex != INDEX_NONE)
+	{
+		float RopeLength = SwingManager->GetRopeState(SwingRopeIndex).RopeLength;
+		FVector Previous = HookInstance->GetActorLocation();
+		for (const FRopeWrap& Wrap : RopeWraps)
+		{
+			RopeLength += FVector::Dist(Previous, Wrap.Location);
+			Previous = Wrap.Location;
+		}
+		HookRopeLengths[0] = RopeLength;
+	}
+
+	FVector Anchors[GH_MAX_ROPES_PER_BODY];
+	float Lengths[GH_MAX_ROPES_PER_BODY];
+	int32 NumHeld = 0;
+	for (int32 HookIndex = 0; HookIndex < Hooks.Num(); ++HookIndex)
+	{
+		if (Hooks[HookIndex]->GetState() != AGH_Hook::State::HOOKED)
+		{
+			HookRopeLengths[HookIndex] = 0.f;
+			continue;
+		}
+
+		// A rope joining the hold keeps the length it was paid out to
+		Anchors[NumHeld] = Hooks[HookIndex]->GetActorLocation();
+		if (HookRopeLengths[HookIndex] <= 0.f)
+		{
+			HookRopeLengths[HookIndex] = FVector::Dist(MuzzleWorldLocation, Anchors[NumHeld]);
+		}
+		Lengths[NumHeld] = HookRopeLengths[HookIndex];
+		++NumHeld;
+	}
+
+	// Simulated proxies only replicate the pendulum of the primary rope, other holds follow the replicated movement
+	const bool bPrimaryOnly = NumHeld == 1 && HookInstance->GetState() == AGH_Hook::State::HOOKED;
+	if (NumHeld == 0 || (!bPrimaryOnly && Role == ROLE_SimulatedProxy))
+	{
+		if (RopeLocked)
+		{
+			UnlockRope();
+		}
+		return;
+	}
+
+	if (bPrimaryOnly)
+	{
+		if (SwingRopeIndex != INDEX_NONE)
+		{
+			return;
+		}
+
+		if (RopeBodyIndex == INDEX_NONE)
+		{
+			const FVector diffVec = Anchors[0] - MuzzleWorldLocation;
+			LockRope(FGH_Pendulum::Lock(FGH_SwingVector(diffVec.X, diffVec.Y, diffVec.Z)));
+			return;
+		}
+
+		// Back to the primary rope alone, the pendulum goes on with the body velocity
+		FVector BodyPosition, BodyVelocity;
+		SwingManager->GetBodyState(RopeBodyIndex, BodyPosition, BodyVelocity);
+		SwingManager->UnregisterBody(RopeBodyIndex);
+		RopeBodyIndex = INDEX_NONE;
+
+		// The body moves in world space, the pendulum in the frame of its anchor
+		const FVector BodyToAnchor = Anchors[0] - BodyPosition;
+		BodyVelocity -= GetSwingFrameVelocity();
+		LockRope(FGH_Pendulum::Lock(FGH_SwingVector(BodyToAnchor.X, BodyToAnchor.Y, BodyToAnchor.Z), FGH_SwingVector(BodyVelocity.X, BodyVelocity.Y, BodyVelocity.Z)));
+		return;
+	}
+
+	if (RopeBodyIndex == INDEX_NONE)
+	{
+		// The pendulum hands its velocity over to the body
+		FVector Velocity = GetCharacterMovement()->Velocity;
+		if (SwingRopeIndex != INDEX_NONE)
+		{
+			const FGH_SwingVector SwingVelocity = FGH_Pendulum::GetVelocity(SwingManager->GetRopeState(SwingRopeIndex));
+			Velocity = FVector(SwingVelocity.X, SwingVelocity.Y, SwingVelocity.Z) + GetSwingFrameVelocity();
+
+			SwingManager->UnregisterRope(SwingRopeIndex);
+			SwingRopeIndex = INDEX_NONE;
+			ResetRopeWraps();
+		}
+		LockRopeBody(Velocity);
+	}
+
+	SwingManager->SetBodyRopes(RopeBodyIndex, Anchors, Lengths, NumHeld);
+	UpdateAnchorFollowing();
+}
+
+void AGH_Character::UpdateAnchorFollowing()
+{
+	bool bMovingAnchor = false;
+	for (const AGH_Hook* CharacterHook : Hooks)
+	{
+		bMovingAnchor |= RopeLocked && CharacterHook->IsOnMovingAnchor();
+	}
+
+	// The pendulum frame restarts from the anchor velocity when the primary hook hangs from a new anchor
+	UPrimitiveComponent* FrameAnchor = RopeLocked && HookInstance->IsOnMovingAnchor() ? HookInstance->GetAnchorComponent() : nullptr;
+	if (FrameAnchor != SwingFrameAnchor.Get())
+	{
+		SwingFrameAnchor = FrameAnchor;
+		RestartAnchorRead();
+	}
+
+	if (bMovingAnchor != bFollowingAnchors)
+	{
+		bFollowingAnchors = bMovingAnchor;
+		SwingManager->SetFollowsAnchors(this, bMovingAnchor);
+
+		// Wrap points are fixed in world space, they would not follow the anchor
+		if (bMovingAnchor)
+		{
+			ResetRopeWraps();
+		}
+	}
+}
+
+void AGH_Character::RestartAnchorRead()
+{
+	FrameAnchorLocation = HookInstance->GetActorLocation();
+	FrameAnchorVelocity = HookInstance->GetAnchorVelocity();
+	FrameAnchorReadTime = GetWorld()->GetTimeSeconds();
+}
+
+FVector AGH_Character::GetSwingFrameVelocity() const
+{
+	return SwingFrameAnchor.IsValid() ? FrameAnchorVelocity : FVector::ZeroVector;
+}
+
+void AGH_Character::FollowRopeAnchors()
+{
+	GH_SCOPE_CYCLE_COUNTER(FollowRopeAnchors);
+
+	// The body solver works in world space, its ropes only move with their hooks.
+	// A pendulum it hands over to measures the anchor from now
+	if (RopeBodyIndex != INDEX_NONE)
+	{
+		RestartAnchorRead();
+		RefreshRopeHold();
+		return;
+	}
+
+	if (SwingRopeIndex == INDEX_NONE || !SwingFrameAnchor.IsValid())
+	{
+		return;
+	}
+
+	// Measured over the frames since the last read, not over the swing steps: the fixed steps of a frame cover more or less than its time.
+	// The anchor was read in this frame already when the rope locked after the swing manager ticked
+	const float Now = GetWorld()->GetTimeSeconds();
+	const float Seconds = Now - FrameAnchorReadTime;
+	if (Seconds <= KINDA_SMALL_NUMBER)
+	{
+		return;
+	}
+
+	// The hook is attached to its anchor, reading its location reads the anchor transform once for all the steps.
+	// Simulating anchors give their velocity at the hook, the others are measured from their movement
+	UPrimitiveComponent* Anchor = SwingFrameAnchor.Get();
+	const FVector Location = HookInstance->GetActorLocation();
+	const FVector Velocity = Anchor->IsSimulatingPhysics() ? Anchor->GetPhysicsLinearVelocityAtPoint(Location) : (Location - FrameAnchorLocation) / Seconds;
+	const FVector Acceleration = (Velocity - FrameAnchorVelocity) / Seconds;
+	FrameAnchorLocation = Location;
+	FrameAnchorVelocity = Velocity;
+	FrameAnchorReadTime = Now;
+
+	SwingManager->AccelerateRopeAnchor(SwingRopeIndex, Acceleration, Seconds);
+
+	// The rope pulls the simulating anchor towards the body
+	if (AnchorImpulseScale > 0.f && Anchor->IsSimulatingPhysics())
+	{
+		const FGH_PendulumState State = SwingManager->GetRopeState(SwingRopeIndex);
+		const float Tension = FGH_Pendulum::GetTension(State, SwingManager->GetSettings().Gravity, FGH_SwingVector(Acceleration.X, Acceleration.Y, Acceleration.Z));
+		const FGH_SwingVector Offset = FGH_Pendulum::GetOffset(State, State.Angle);
+		const FVector RopeDirection = FVector(Offset.X, Offset.Y, Offset.Z) / State.RopeLength;
+
+		Anchor->AddImpulseAtLocation(RopeDirection * (Tension * GetCharacterMovement()->Mass * Seconds * AnchorImpulseScale), Location);
+	}
+}
+
+void AGH_Character::ApplyRopeBody(const FVector& Position)
+{
+	GH_SCOPE_CYCLE_COUNTER(ApplySwing);
+
+	CastChecked<UGH_CharacterMovementComponent>(GetCharacterMovement())->SetSwingTarget(Position - GetMuzzleLocalLocation());
+}
+
+FVector AGH_Character::PredictRopeBodyLocation(float DeltaSeconds) const
+{
+	return SwingManager->PredictBody(RopeBodyIndex, GetMuzzleWorldLocation(), GetCharacterMovement()->Velocity, DeltaSeconds) - GetMuzzleLocalLocation();
+}
+
+void AGH_Character::ApplySwing(const FVector& HookToMuzzle)
+{
+	GH_SCOPE_CYCLE_COUNTER(ApplySwing);
+
+	CastChecked<UGH_CharacterMovementComponent>(GetCharacterMovement())->SetSwingTarget(GetSwingAnchor() + HookToMuzzle - GetMuzzleLocalLocation());
+
+	if (HasAuthority())
+	{
+		ReplicatedSwing = FGH_SwingReplication::FromState(SwingManager->GetRopeState(SwingRopeIndex), LockId, GetNumRopeWraps());
+	}
+}
+
+bool AGH_Character::GetSwingState(FGH_PendulumState& OutState) const
+{
+	if (!RopeLocked || SwingRopeIndex == INDEX_NONE || SwingManager == nullptr)
+	{
+		return false;
+	}
+
+	OutState = SwingManager->GetRopeState(SwingRopeIndex);
+	return true;
+}
+
+bool AGH_Character::IsSwingMoveDriven() const
+{
+	return SwingRopeIndex != INDEX_NONE && SwingManager->IsRopeMoveDriven(SwingRopeIndex);
+}
+
+bool AGH_Character::GetSwingMove(FGH_FixedStepPendulum& OutSolver) const
+{
+	if (!GetSwingState(OutSolver.State))
+	{
+		return false;
+	}
+
+	OutSolver.PreviousAngle = SwingManager->GetRopePreviousAngle(SwingRopeIndex);
+	OutSolver.TimeAccumulator = SwingMoveTime;
+	return true;
+}
+
+void AGH_Character::CommitSwingMove(const FGH_FixedStepPendulum& Solver)
+{
+	SwingManager->SetRopeState(SwingRopeIndex, Solver.State, Solver.PreviousAngle);
+	SwingMoveTime = Solver.TimeAccumulator;
+
+	if (HasAuthority())
+	{
+		ReplicatedSwing = FGH_SwingReplication::FromState(Solver.State, LockId, GetNumRopeWraps());
+	}
+}
+
+FGH_PendulumSettings AGH_Character::GetSwingSettings() const
+{
+	return SwingManager->GetSettings();
+}
+
+FVector AGH_Character::GetSwingLocation(const FGH_PendulumState& State, float Angle) const
+{
+	const FGH_SwingVector Offset = FGH_Pendulum::GetOffset(State, Angle);
+	return GetSwingOrigin() + FVector(Offset.X, Offset.Y, Offset.Z);
+}
+
+FVector AGH_Character::GetSwingOrigin() const
+{
+	return GetSwingAnchor() - GetMuzzleLocalLocation();
+}
+
+FVector AGH_Character::GetSwingAnchor() const
+{
+	return RopeWraps.Num() > 0 ? RopeWraps.Last().Location : HookInstance->GetActorLocation();
+}
+
+void AGH_Character::OnSwingMoved(bool bBlocked)
+{
+	// Restart the pendulum from where the body was stopped, with the velocity the impact left it
+	if (bBlocked && SwingRopeIndex != INDEX_NONE)
+	{
+		SwingAround(GetSwingAnchor(), GetCharacterMovement()->Velocity - GetSwingFrameVelocity());
+	}
+	else if (bBlocked && RopeBodyIndex != INDEX_NONE)
+	{
+		SwingManager->SetBodyState(RopeBodyIndex, GetMuzzleWorldLocation(), GetCharacterMovement()->Velocity);
+	}
+
+	if (SwingRopeIndex != INDEX_NONE)
+	{
+		UpdateRopeWrap();
+	}
+
+	UpdateRopes();
+}
+
+void AGH_Character::SwingAround(const FVector& Pivot, const FVector& Velocity)
+{
+	const FVector BodyToAnchor = Pivot - GetMuzzleWorldLocation();
+	FGH_PendulumState State = FGH_Pendulum::Lock(FGH_SwingVector(BodyToAnchor.X, BodyToAnchor.Y, BodyToAnchor.Z), FGH_SwingVector(Velocity.X, Velocity.Y, Velocity.Z));
+	State.ReelSpeed = SwingManager->GetRopeState(SwingRopeIndex).ReelSpeed;
+	SwingManager->SetRopeState(SwingRopeIndex, State);
+}
+
+void AGH_Character::UpdateRopeWrap()
+{
+	GH_SCOPE_CYCLE_COUNTER(RopeWrap);
+
+	// Simulated proxies take the wrap points of the server
+	if (!bWrapRope || bFollowingAnchors || Role == ROLE_SimulatedProxy)
+	{
+		return;
+	}
+
+	// The segments between the hook and the last wrap point do not move, only the last one is traced, at most once per swing step
+	const uint32 Step = SwingManager->GetStepCounter();
+	const FVector Pivot = GetSwingAnchor();
+	const FVector MuzzleWorldLocation = GetMuzzleWorldLocation();
+	if (Step == RopeWrapStep || (Pivot.Equals(RopeWrapTraceStart, 1.f) && MuzzleWorldLocation.Equals(RopeWrapTraceEnd, 1.f)))
+	{
+		return;
+	}
+	RopeWrapStep = Step;
+	RopeWrapTraceStart = Pivot;
+	RopeWrapTraceEnd = MuzzleWorldLocation;
+
+	const FGH_SwingVector SwingVelocity = FGH_Pendulum::GetVelocity(SwingManager->GetRopeState(SwingRopeIndex));
+	const FVector Velocity(SwingVelocity.X, SwingVelocity.Y, SwingVelocity.Z);
+
+	// The rope bends the other way than when it wrapped, it leaves the last wrap point
+	if (RopeWraps.Num() > 0)
+	{
+		const FVector Previous = RopeWraps.Num() > 1 ? RopeWraps[RopeWraps.Num() - 2].Location : HookInstance->GetActorLocation();
+		const FVector Bend = FVector::CrossProduct(Pivot - Previous, MuzzleWorldLocation - Pivot);
+		if ((Bend | RopeWraps.Last().BendNormal) < 0.f)
+		{
+			RopeWraps.Pop(false);
+			SwingAround(Previous, Velocity);
+			OnRopeWrapsChanged();
+			return;
+		}
+	}
+
+	if (RopeWraps.Num() >= MaxRopeWraps)
+	{
+		return;
+	}
+
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(RopeWrap), false, this);
+	for (AGH_Hook* CharacterHook : Hooks)
+	{
+		Params.AddIgnoredActor(CharacterHook);
+	}
+
+	++FGH_FrameCounters::Get().RopeWrapTraces;
+	INC_DWORD_STAT(STAT_GH_RopeWrapTraces);
+	CSV_CUSTOM_STAT(Grappling, RopeWrapTraces, 1, ECsvCustomStatOp::Accumulate);
+
+	// Hits right at the pivot are the geometry it already wraps around
+	FHitResult Hit;
+	if (!GetWorld()->LineTraceSingleByChannel(Hit, Pivot, MuzzleWorldLocation, RopeWrapChannel, Params) || Hit.bStartPenetrating || Hit.Distance <= 2.f * RopeWrapOffset)
+	{
+		return;
+	}
+
+	// Too close to the body for the pendulum, the swing slides along the geometry instead
+	const FVector WrapLocation = Hit.ImpactPoint + Hit.ImpactNormal * RopeWrapOffset;
+	if (FVector::Dist(WrapLocation, MuzzleWorldLocation) < SwingManager->MinRopeLength)
+	{
+		return;
+	}
+
+	// Pushed off the surface, the wrap point sits on the outer side of the bend
+	FRopeWrap Wrap;
+	Wrap.Location = WrapLocation;
+	Wrap.BendNormal = FVector::CrossProduct(WrapLocation - Pivot, MuzzleWorldLocation - WrapLocation);
+	RopeWraps.Add(Wrap);
+
+	SwingAround(WrapLocation, Velocity);
+	OnRopeWrapsChanged();
+}
+
+void AGH_Character::ResetRopeWraps()
+{
+	if (RopeWraps.Num() == 0)
+	{
+		return;
+	}
+
+	RopeWraps.Reset();
+	OnRopeWrapsChanged();
+}
+
+void AGH_Character::UpdateRopeBends()
+{
+	TArray<FVector, TInlineAllocator<8>> Bends;
+	for (const FRopeWrap& Wrap : RopeWraps)
+	{
+		Bends.Add(Wrap.Location);
+	}
+	Ropes[0]->SetBends(Bends.GetData(), Bends.Num());
+}
+
+void AGH_Character::OnRopeWrapsChanged()
+{
+	UpdateRopeBends();
+
+	if (HasAuthority())
+	{
+		ReplicatedRopeWraps.SetNum(RopeWraps.Num());
+		for (int32 WrapIndex = 0; WrapIndex < RopeWraps.Num(); ++WrapIndex)
+		{
+			ReplicatedRopeWraps[WrapIndex].Location = RopeWraps[WrapIndex].Location;
+			ReplicatedRopeWraps[WrapIndex].BendNormal = RopeWraps[WrapIndex].BendNormal.GetSafeNormal();
+		}
+	}
+}
+
+int32 AGH_Character::CountReplicatedRopeWraps() const
+{
+	// The client traces from a slightly different body location than the server
+	int32 NumWraps = 0;
+	while (NumWraps < RopeWraps.Num() && NumWraps < ReplicatedRopeWraps.Num() && RopeWraps[NumWraps].Location.Equals(ReplicatedRopeWraps[NumWraps].Location, GRopeWrapMatchDistance))
+	{
+		++NumWraps;
+	}
+	return NumWraps;
+}
+
+void AGH_Character::AdoptReplicatedRopeWraps()
+{
+	RopeWraps.SetNum(ReplicatedRopeWraps.Num());
+	for (int32 WrapIndex = 0; WrapIndex < RopeWraps.Num(); ++WrapIndex)
+	{
+		RopeWraps[WrapIndex].Location = ReplicatedRopeWraps[WrapIndex].Location;
+		RopeWraps[WrapIndex].BendNormal = ReplicatedRopeWraps[WrapIndex].BendNormal;
+	}
+	UpdateRopeBends();
+}
+
+void AGH_Character::ApplyClientSwing(FGH_PendulumState& State, const FGH_PendulumState& ClientState, uint8 ClientNumWraps) const
+{
+	// Around another wrap point the client state is measured from another pivot
+	if (ClientNumWraps != RopeWraps.Num())
+	{
+		return;
+	}
+
+	// Larger differences are left to the server, the client gets corrected by the replicated swing
+	const float AngleError = FMath::FindDeltaAngleRadians(State.Angle, ClientState.Angle);
+	if (FMath::Abs(AngleError) <= FMath::DegreesToRadians(SwingSnapAngle) && FMath::Abs(State.RopeLength - ClientState.RopeLength) <= ReelLengthTolerance)
+	{
+		State = ClientState;
+	}
+}
+
+bool AGH_Character::ServerSwingMove_Validate(const FGH_SwingMoveData& Data)
+{
+	return true;
+}
+
+void AGH_Character::ServerSwingMove_Implementation(const FGH_SwingMoveData& Data)
+{
+	CastChecked<UGH_CharacterMovementComponent>(GetCharacterMovement())->ReceiveSwingMove(Data);
+}
+
+void AGH_Character::UnlockRope()
+{
+	GH_SCOPE_CYCLE_COUNTER(UnlockRope);
+
+	RopeLocked = false;
+
+	FVector ReleaseVelocity = GetCharacterMovement()->Velocity;
+	if (SwingRopeIndex != INDEX_NONE)
+	{
+		const FGH_SwingVector SwingVelocity = FGH_Pendulum::GetVelocity(SwingManager->GetRopeState(SwingRopeIndex));
+		ReleaseVelocity = FVector(SwingVelocity.X, SwingVelocity.Y, SwingVelocity.Z) + GetSwingFrameVelocity();
+
+		SwingManager->UnregisterRope(SwingRopeIndex);
+		SwingRopeIndex = INDEX_NONE;
+	}
+	else if (RopeBodyIndex != INDEX_NONE)
+	{
+		FVector BodyPosition;
+		SwingManager->GetBodyState(RopeBodyIndex, BodyPosition, ReleaseVelocity);
+
+		SwingManager->UnregisterBody(RopeBodyIndex);
+		RopeBodyIndex = INDEX_NONE;
+	}
+	ResetRopeWraps();
+	UpdateAnchorFollowing();
+
+	for (float& Length : HookRopeLengths)
+	{
+		Length = 0.f;
+	}
+
+	// Leave the rope with the velocity the body had on the pendulum
+	UGH_CharacterMovementComponent* Movement = CastChecked<UGH_CharacterMovementComponent>(GetCharacterMovement());
+	if (Movement->IsSwinging())
+	{
+		Movement->SetMovementMode(MOVE_Falling);
+	}
+	Movement->Velocity = ReleaseVelocity;
+
+	UpdateTickEnabled();
+}
+
+void AGH_Character::MoveForward(float Value)
+{
+	if (ReplayRecorder != nullptr)
+	{
+		ReplayRecorder->RecordAxis(&FGH_ReplayFrame::MoveForward, Value);
+	}
+
+	if (Value != 0.0f)
+	{
+		// add movement in that direction
+		AddMovementInput(GetActorForwardVector(), Value);
+	}
+}
+
+void AGH_Character::MoveRight(float Value)
+{
+	if (ReplayRecorder != nullptr)
+	{
+		ReplayRecorder->RecordAxis(&FGH_ReplayFrame::MoveRight, Value);
+	}
+
+	if (Value != 0.0f)
+	{
+		// add movement in that direction
+		AddMovementInput(GetActorRightVector(), Value);
+	}
+}
+
+void AGH_Character::Turn(float Value)
+{
+	if (ReplayRecorder != nullptr)
+	{
+		ReplayRecorder->RecordAxis(&FGH_ReplayFrame::Turn, Value);
+	}
+
+	AddControllerYawInput(Value);
+}
+
+void AGH_Character::LookUp(float Value)
+{
+	if (ReplayRecorder != nullptr)
+	{
+		ReplayRecorder->RecordAxis(&FGH_ReplayFrame::LookUp, Value);
+	}
+
+	AddControllerPitchInput(Value);
+}
+
+void AGH_Character::Reel(float Value)
+{
+	if (ReplayRecorder != nullptr)
+	{
+		ReplayRecorder->RecordAxis(&FGH_ReplayFrame::Reel, Value);
+	}
+
+	SetReelInput(Value);
+}
+
+void AGH_Character::TurnAtRate(float Rate)
+{
+	// calculate delta for this frame from the rate information
+	Turn(Rate * BaseTurnRate * GetWorld()->GetDeltaSeconds());
+}
+
+void AGH_Character::LookUpAtRate(float Rate)
+{
+	// calculate delta for this frame from the rate information
+	LookUp(Rate * BaseLookUpRate * GetWorld()->GetDeltaSeconds());
+}
+
+void AGH_Character::OnJumpPressed()
+{
+	if (ReplayRecorder != nullptr)
+	{
+		ReplayRecorder->RecordButton(GH_REPLAY_JumpPressed);
+	}
+
+	Jump();
+}
+
+void AGH_Character::OnJumpReleased()
+{
+	if (ReplayRecorder != nullptr)
+	{
+		ReplayRecorder->RecordButton(GH_REPLAY_JumpReleased);
+	}
+
+	StopJumping();
+}
+
+void AGH_Character::ApplyReplayFrame(const FGH_ReplayFrame& Frame)
+{
+	MoveForward(Frame.MoveForward);
+	MoveRight(Frame.MoveRight);
+	Turn(Frame.Turn);
+	LookUp(Frame.LookUp);
+	Reel(Frame.Reel);
+
+	if (Frame.Buttons & GH_REPLAY_JumpPressed)
+	{
+		OnJumpPressed();
+	}
+	if (Frame.Buttons & GH_REPLAY_JumpReleased)
+	{
+		OnJumpReleased();
+	}
+	if (Frame.Buttons & GH_REPLAY_Fire)
+	{
+		OnFire();
+	}
+	if (Frame.Buttons & GH_REPLAY_FireSecondary)
+	{
+		OnFireSecondary();
+	}
+}
@@ -5,12 +5,14 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "GH_Hook.h"
-#include "Engine/SkeletalMeshSocket.h"
+#include "GH_SwingReplication.h"
+#include "GH_MuzzleAnchor.h"
+#include "Algorithm/GH_RopeConstraints.h"
 
 #include "GH_Character.generated.h"
 
-class AStaticMeshActor;
-class APhysicsConstraintActor;
+class UGH_RopeComponent;
+class AGH_SwingManager;
 
 UCLASS(config = Game)
 class GRAPPLINGHOOD_API AGH_Character : public ACharacter
@@ -35,12 +37,18 @@ class GRAPPLINGHOOD_API AGH_Character : public ACharacter
 
 public:
 	// Sets default values for this character's properties
-	AGH_Character();
+	AGH_Character(const FObjectInitializer& ObjectInitializer);
 
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	// Called when the character is removed from the world
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Called on the owning client when a local player possesses the character
+	virtual void PawnClientRestart() override;
+
 public:	
 	/** Base turn rate, in deg/sec. Other scaling may affect final turn rate. */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera)
@@ -61,7 +69,13 @@ public:
 	/** Hook projectile reference */
 	AGH_Hook* Hook;
 
-	AStaticMeshActor* Rope;
+	/** Rope visual between the muzzle and the hook */
+	UPROPERTY(VisibleDefaultsOnly, BlueprintReadOnly, Category = Hook)
+	UGH_RopeComponent* Rope;
+
+	/** Hooks carried by the character, the secondary fire shoots the extra ones. The character hangs from every hooked rope at once */
+	UPROPERTY(EditDefaultsOnly, Config, BlueprintReadOnly, Category = Hook, meta = (ClampMin = "1", ClampMax = "4"))
+	int32 NumHooks = 1;
 
 	///** Projectile class to spawn */
 	//UPROPERTY(EditDefaultsOnly, Category = Hook)
@@ -75,42 +89,283 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
 	class UAnimMontage* FireAnimation;
 
+	/** Half angle of the cone around the aim in which the hook snaps to a level anchor (in degrees), 0 to fire straight */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Hook, meta = (ClampMin = "0", ClampMax = "90"))
+	float AnchorAimAngle = 10.f;
+
+	/** Farthest level anchor the hook snaps to (in cm) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Hook, meta = (ClampMin = "0"))
+	float AnchorAimRange = 10000.f;
+
+	/** Speed the rope is reeled in or out at while swinging (in cm/s) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Hook, meta = (ClampMin = "0"))
+	float ReelSpeed = 600.f;
+
+	/** The primary rope wraps around the geometry it crosses while swinging, the pendulum then swings around the last wrap point */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Hook)
+	bool bWrapRope = true;
+
+	/** Most points the rope wraps around */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Hook, meta = (ClampMin = "0"))
+	int32 MaxRopeWraps = 8;
+
+	/** Distance between the geometry and the point the rope wraps around (in cm) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Hook, meta = (ClampMin = "1"))
+	float RopeWrapOffset = 5.f;
+
+	/** Channel of the traces finding the geometry the rope wraps around */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Hook)
+	TEnumAsByte<ECollisionChannel> RopeWrapChannel = ECC_Visibility;
+
+	/** Part of the rope pull applied back to the simulating bodies the primary hook hangs from */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Hook, meta = (ClampMin = "0"))
+	float AnchorImpulseScale = 1.f;
+
+	/** Swing angle error with the server (in degrees) above which the local rope snaps to the server state */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Network, meta = (ClampMin = "0"))
+	float SwingSnapAngle = 10.f;
+
+	/** Part of a smaller swing error corrected at each server update */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Network, meta = (ClampMin = "0", ClampMax = "1"))
+	float SwingCorrectionBlend = 0.3f;
+
+	/** Rope length difference with the server (in cm) the owning client keeps, it reels ahead of the server */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Network, meta = (ClampMin = "0"))
+	float ReelLengthTolerance = 150.f;
+
 protected:
 
+	/** Primary hook, first entry of Hooks */
 	AGH_Hook* HookInstance = nullptr;
 
-	UStaticMesh* RopeMesh = nullptr;
-	TArray<APhysicsConstraintActor*> PhysicsConstraints;
+	/** Every hook of the character, the primary hook first */
+	UPROPERTY(Transient)
+	TArray<AGH_Hook*> Hooks;
+
+	/** Rope visual of each hook, Rope first */
+	UPROPERTY(Transient)
+	TArray<UGH_RopeComponent*> Ropes;
+
+	/** Length of the rope of each hook holding the character, 0 when the hook does not hold it */
+	TArray<float> HookRopeLengths;
+
+	/** Hook state decided by the server */
+	UPROPERTY(ReplicatedUsing = OnRep_ReplicatedHook)
+	FGH_HookReplication ReplicatedHook;
+
+	/** State of the extra hooks decided by the server, the primary hook is in ReplicatedHook */
+	UPROPERTY(ReplicatedUsing = OnRep_ReplicatedSecondaryHooks)
+	TArray<FGH_HookReplication> ReplicatedSecondaryHooks;
+
+	/** Swing state of the locked rope, updated by the server */
+	UPROPERTY(ReplicatedUsing = OnRep_ReplicatedSwing)
+	FGH_SwingReplication ReplicatedSwing;
+
+	/** Points the primary rope wraps around on the server, applied with ReplicatedSwing */
+	UPROPERTY(Replicated)
+	TArray<FGH_RopeWrapReplication> ReplicatedRopeWraps;
+
+	/** Last shot fired by each hook, by the local input on the owning client and by the server RPC on the server */
+	uint8 LocalShotIds[GH_MAX_ROPES_PER_BODY] = {};
+
+	/** Last rope lock, counted by the server and followed by the clients */
+	uint8 LockId = 0;
+
 
 	bool RopeLocked = false;
 
-	float SwingRopeLength;
-	float SwingAngle;
-	float SwingAngleVelocity;
-	FVector SwingPlaneNormal;
-	float SwingZRotation;
-	FVector SwingLastDelta;
+	/** Pool the hook is taken from */
+	UPROPERTY(Transient)
+	class AGH_ActorPool* ActorPool = nullptr;
+
+	/** World service previewing where the hook would attach */
+	UPROPERTY(Transient)
+	class AGH_HookTargeting* HookTargeting = nullptr;
+
+	/** Anchors of the level, null when the level has no index */
+	UPROPERTY(Transient)
+	class AGH_AnchorIndex* AnchorIndex = nullptr;
+
+	/** Records the inputs of the local character when asked */
+	UPROPERTY(Transient)
+	class AGH_ReplayRecorder* ReplayRecorder = nullptr;
+
+	/** World solver advancing the locked rope */
+	UPROPERTY(Transient)
+	AGH_SwingManager* SwingManager = nullptr;
+
+	/** Index of the locked rope in the swing manager */
+	int32 SwingRopeIndex = INDEX_NONE;
+
+	/** Time the moves of a move driven swing left to its next fixed step */
+	float SwingMoveTime = 0.f;
+
+	/** Index of the body in the swing manager while the character hangs from several ropes */
+	int32 RopeBodyIndex = INDEX_NONE;
+
+	/** Point the primary rope wraps around */
+	struct FRopeWrap
+	{
+		FVector Location;
+		/** Bend of the rope when it wrapped, the rope unwraps once it bends the other way */
+		FVector BendNormal;
+	};
+
+	/** Points the primary rope wraps around, from the hook. Only the segment after the last one moves */
+	TArray<FRopeWrap> RopeWraps;
+
+	/** Swing manager step the moving rope segment was last traced at */
+	uint32 RopeWrapStep = 0;
+
+	/** Moving rope segment last traced, not traced again until it moves */
+	FVector RopeWrapTraceStart = FVector::ZeroVector;
+	FVector RopeWrapTraceEnd = FVector::ZeroVector;
+
+	/** Traces the moving segment of the primary rope once per swing step, wrapping it around the geometry it crosses or unwrapping its last point */
+	void UpdateRopeWrap();
+
+	/** Restarts the pendulum around the given pivot with the given body velocity, keeping the reel going */
+	void SwingAround(const FVector& Pivot, const FVector& Velocity);
+
+	/** Unwraps the whole rope */
+	void ResetRopeWraps();
+
+	/** Sends the wrap points to the primary rope visual */
+	void UpdateRopeBends();
+
+	/** Updates the rope visual and, on the server, the replicated wrap points */
+	void OnRopeWrapsChanged();
+
+	/** Number of wrap points, from the hook, at the same place locally and on the server */
+	int32 CountReplicatedRopeWraps() const;
+
+	/** Takes the wrap points of the server */
+	void AdoptReplicatedRopeWraps();
+
+	/** Whether a held rope hangs from a moving anchor, the swing manager then calls FollowRopeAnchors */
+	bool bFollowingAnchors = false;
+
+	/** Moving component the primary hook hangs from, the pendulum swings in its frame */
+	TWeakObjectPtr<UPrimitiveComponent> SwingFrameAnchor;
+
+	/** Location and velocity of the primary hook at the last swing steps */
+	FVector FrameAnchorLocation = FVector::ZeroVector;
+	FVector FrameAnchorVelocity = FVector::ZeroVector;
+
+	/** World time FrameAnchorLocation was read at, the velocity is measured over the real elapsed time */
+	float FrameAnchorReadTime = 0.f;
+
+	/** Reads the primary hook location and its anchor velocity, the next anchor acceleration is measured from them */
+	void RestartAnchorRead();
+
+	/** Starts or stops following the moving anchors when the held ropes change */
+	void UpdateAnchorFollowing();
+
+	/** Returns the velocity of the frame the pendulum swings in, zero on a static anchor */
+	FVector GetSwingFrameVelocity() const;
+
+	/** Reel input in [-1, 1], positive to reel in, sent to the server when it changes */
+	float ReelInput = 0.f;
+
+	/** Muzzle socket of the gun mesh, resolved in BeginPlay */
+	FGH_MuzzleAnchor Muzzle;
 
 	/** Fires a projectile. */
 	void OnFire();
 
+	/** Fires the first docked extra hook, or releases the extra hooks when none is docked */
+	void OnFireSecondary();
+
+	/** Fires the hook, predicted on the owning client and run again by the server */
+	void FireHook(int32 HookIndex, const FVector& Direction);
+
+	/** Retracts the hook, its rope stops holding the character */
+	void ReleaseHook(int32 HookIndex);
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerFire(FVector_NetQuantizeNormal Direction, uint8 ShotId, uint8 HookIndex);
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerRelease(uint8 ShotId, uint8 HookIndex);
+
+	/** Reel input of the owning client, quantized on a signed byte */
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerReel(int8 QuantizedInput);
+
+	/** Updates the reel input, the locked rope follows it */
+	void SetReelInput(float Value);
+
+	/** Gives the reel speed of the input to the locked rope */
+	void ApplyReelInput();
+
+	/** Brings the local hook to the state decided by the server */
+	UFUNCTION()
+	void OnRep_ReplicatedHook();
+
+	UFUNCTION()
+	void OnRep_ReplicatedSecondaryHooks();
+
+	/** Brings a local hook to the given server state */
+	void ApplyReplicatedHook(int32 HookIndex, const FGH_HookReplication& Replication);
+
+	UFUNCTION()
+	void OnRep_ReplicatedSwing();
+
+	/** Locks the rope with the server swing state, or corrects the locally predicted swing towards it */
+	void ReconcileSwing();
+
+	/** Direction the hook is fired in, towards the level anchor closest to the aim if any */
+	FVector GetFireDirection() const;
+
 	/** Fires a projectile. */
-	void UpdateRope();
+	void UpdateRope(int32 HookIndex);
+
+	/** Updates the ropes of every hook out of the gun */
+	void UpdateRopes();
 
 	/** Fires a projectile. */
 	void LockRope();
 
-	void SwingCharacter(float DeltaSeconds);
+	/** Starts swinging from the given pendulum state */
+	void LockRope(const FGH_PendulumState& State);
+
+	/** Starts hanging from several ropes with the given velocity, the ropes are set by RefreshRopeHold */
+	void LockRopeBody(const FVector& Velocity);
+
+	/**
+	 * Hangs the character from every hooked rope. The primary rope alone swings on the pendulum,
+	 * any other set of ropes holds a body solved by the swing manager.
+	 */
+	void RefreshRopeHold();
 
 	/** Fires a projectile. */
 	void UnlockRope();
 
+	/** Reacts to the hook transitions instead of polling its state */
+	void OnHookStateChanged(AGH_Hook* ChangedHook, AGH_Hook::State PreviousState, AGH_Hook::State NewState);
+
+	/** Ticks only while a rope follows its hook or the character must check for a lock */
+	void UpdateTickEnabled();
+
 	/** Handles moving forward/backward */
 	void MoveForward(float Val);
 
 	/** Handles strafing movement, left and right */
 	void MoveRight(float Val);
 
+	/** Handles the yaw input */
+	void Turn(float Val);
+
+	/** Handles the pitch input */
+	void LookUp(float Val);
+
+	/** Handles the rope reel input, positive to reel in */
+	void Reel(float Val);
+
+	/** Handles the jump button */
+	void OnJumpPressed();
+	void OnJumpReleased();
+
 	/**
 	 * Called via input to turn at a given rate.
 	 * @param Rate	This is a normalized rate, i.e. 1.0 means 100% of desired turn rate
@@ -129,12 +384,98 @@ protected:
 	virtual void Tick(float DeltaSeconds) override;
 
 public:
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** Sends the character to the swing offset from the hook computed by the swing manager, moved by the next swing move */
+	void ApplySwing(const FVector& HookToMuzzle);
+
+	/** Returns the current pendulum state, false if the rope is not locked */
+	bool GetSwingState(FGH_PendulumState& OutState) const;
+
+	/** Points the primary rope wraps around, the pendulum state is relative to the last one */
+	FORCEINLINE uint8 GetNumRopeWraps() const { return static_cast<uint8>(RopeWraps.Num()); }
+
+	/** Whether the swing is stepped by the moves of the character instead of the swing manager, see AGH_SwingManager::SetRopeMoveDriven */
+	bool IsSwingMoveDriven() const;
+
+	/** Returns the fixed step solver a swing move starts from, false if the rope is not locked */
+	bool GetSwingMove(FGH_FixedStepPendulum& OutSolver) const;
+
+	/** Stores the fixed step solver reached by a swing move run outside the swing manager */
+	void CommitSwingMove(const FGH_FixedStepPendulum& Solver);
+
+	/** Returns the solver settings the swing is simulated with */
+	FGH_PendulumSettings GetSwingSettings() const;
+
+	/** Returns the character location for the given swing angle */
+	FVector GetSwingLocation(const FGH_PendulumState& State, float Angle) const;
+
+	/** Returns the character location the swing offsets are relative to, the swing anchor shifted by the muzzle offset */
+	FVector GetSwingOrigin() const;
+
+	/** Returns the point the pendulum swings around, the last point the rope wraps around or the hook */
+	FVector GetSwingAnchor() const;
+
+	/** Called by the movement component after each swing move */
+	void OnSwingMoved(bool bBlocked);
+
+	/**
+	 * Called by the swing manager before the steps of a frame while a rope hangs from a moving anchor. The pendulum
+	 * feels the acceleration of the anchor since the last read and pulls back on simulating anchors, the ropes of a body follow their hooks.
+	 */
+	void FollowRopeAnchors();
+
+	/** Sends the character to the location of its rope body computed by the swing manager, moved by the next swing move */
+	void ApplyRopeBody(const FVector& Position);
+
+	/** Returns where the rope body moves the character in DeltaSeconds, for the moves run outside the swing manager */
+	FVector PredictRopeBodyLocation(float DeltaSeconds) const;
+
+	/** Fires the hook in the given direction if it is docked, the fire input of the non player controllers */
+	bool FireHookTowards(const FVector& Direction, int32 HookIndex = 0);
+
+	/** Releases the rope and retracts the hook if it was fired */
+	void ReleaseRopeAndHook(int32 HookIndex = 0);
+
+	/** Releases every rope and retracts every fired hook */
+	void ReleaseAllHooks();
+
+	/** Returns whether the rope is locked and the character swinging */
+	FORCEINLINE bool IsRopeLocked() const { return RopeLocked; }
+
+	/** Returns whether the character hangs from several ropes instead of the primary rope pendulum */
+	FORCEINLINE bool IsHeldByRopes() const { return RopeBodyIndex != INDEX_NONE; }
+
+	/** Runs the inputs of a recorded frame, see AGH_ReplayRecorder */
+	void ApplyReplayFrame(const struct FGH_ReplayFrame& Frame);
+
+	/** Server side, adopts into State the swing sent by the owning client if it is close to it and around the same wrap point */
+	void ApplyClientSwing(FGH_PendulumState& State, const FGH_PendulumState& ClientState, uint8 ClientNumWraps) const;
+
+	/** Swing state of a client move, sent by the movement component */
+	UFUNCTION(Server, Unreliable, WithValidation)
+	void ServerSwingMove(const FGH_SwingMoveData& Data);
+
+	/** Called by the swing manager when the locked rope is moved to another index */
+	FORCEINLINE void SetSwingRopeIndex(int32 RopeIndex) { SwingRopeIndex = RopeIndex; }
+
+	/** Called by the swing manager when the rope body is moved to another index */
+	FORCEINLINE void SetRopeBodyIndex(int32 BodyIndex) { RopeBodyIndex = BodyIndex; }
+
+	/** Returns the hook fired by the character **/
+	FORCEINLINE AGH_Hook* GetHookInstance() const { return HookInstance; }
+	/** Returns every hook of the character, the primary hook first **/
+	FORCEINLINE const TArray<AGH_Hook*>& GetHooks() const { return Hooks; }
 	/** Returns Mesh1P subobject **/
 	FORCEINLINE class USkeletalMeshComponent* GetBodyMesh() const { return BodyMesh; }
 	/** Returns FirstPersonCameraComponent subobject **/
 	FORCEINLINE class UCameraComponent* GetCamera() const { return Camera; }
+	/** Returns GunMesh subobject **/
+	FORCEINLINE class USkeletalMeshComponent* GetGunMesh() const { return GunMesh; }
+	/** Returns the cached muzzle socket of the gun **/
+	FORCEINLINE const FGH_MuzzleAnchor& GetMuzzleAnchor() const { return Muzzle; }
 	/** Returns WorldLocation at the tip of the gun subobject */
-	FORCEINLINE FVector GetMuzzleWorldLocation() const { return GunMesh->GetSocketByName("Muzzle")->GetSocketLocation(GunMesh); }
-	/** Returns WorldLocation at the tip of the gun subobject */
-	FORCEINLINE FVector GetMuzzleLocalLocation() const { return GunMesh->GetSocketByName("Muzzle")->RelativeLocation; }
+	FORCEINLINE FVector GetMuzzleWorldLocation() const { return Muzzle.GetWorldLocation(); }
+	/** Returns the location of the tip of the gun relative to its bone */
+	FORCEINLINE FVector GetMuzzleLocalLocation() const { return Muzzle.GetRelativeLocation(); }
 };
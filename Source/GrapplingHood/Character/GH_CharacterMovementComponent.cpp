@@ -0,0 +1,277 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GH_CharacterMovementComponent.h"
+#include "GH_Character.h"
+#include "GH_SavedMove.h"
+#include "GrapplingHood.h"
+#include "Engine/World.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGHMovement, Log, All);
+
+DECLARE_CYCLE_STAT(TEXT("Phys swinging"), STAT_GH_PhysSwinging, STATGROUP_Grappling);
+// Published once per second, an accumulator keeps the value between two updates
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Swing move bytes/s"), STAT_GH_SwingMoveBytesPerSecond, STATGROUP_Grappling);
+
+void UGH_CharacterMovementComponent::ApplySwingImpact(const FHitResult& Hit, const FVector& ImpactVelocity)
+{
+	const float NormalSpeed = -(ImpactVelocity | Hit.Normal);
+	if (NormalSpeed <= 0.f)
+	{
+		return;
+	}
+
+	switch (SwingImpact)
+	{
+	case EGH_SwingImpact::Bounce:
+		// The slide already kept the speed along the surface, only the normal part bounces back
+		Velocity = ImpactVelocity + Hit.Normal * (NormalSpeed * (1.f + SwingBounceRestitution));
+		break;
+
+	case EGH_SwingImpact::Detach:
+		// Replayed moves and simulated proxies leave the release to the authority and the owning client
+		if (NormalSpeed > SwingDetachSpeed && !bClientUpdating && CharacterOwner->Role != ROLE_SimulatedProxy)
+		{
+			UE_LOG(LogGHMovement, Verbose, TEXT("%s: detached by a %.0f cm/s impact"), *GetNameSafe(PawnOwner), NormalSpeed);
+
+			const FVector SlideVelocity = Velocity;
+			GHCharacterOwner->ReleaseAllHooks();
+			Velocity = SlideVelocity;
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+void UGH_CharacterMovementComponent::SetUpdatedComponent(USceneComponent* NewUpdatedComponent)
+{
+	Super::SetUpdatedComponent(NewUpdatedComponent);
+
+	GHCharacterOwner = Cast<AGH_Character>(PawnOwner);
+}
+
+FNetworkPredictionData_Client* UGH_CharacterMovementComponent::GetPredictionData_Client() const
+{
+	if (ClientPredictionData == nullptr)
+	{
+		UGH_CharacterMovementComponent* MutableThis = const_cast<UGH_CharacterMovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FGH_NetworkPredictionData_Client(*this);
+	}
+
+	return ClientPredictionData;
+}
+
+void UGH_CharacterMovementComponent::SetReplaySwing(const FGH_FixedStepPendulum& Swing, uint8 NumWraps)
+{
+	ReplaySwing = Swing;
+	ReplaySwingNumWraps = NumWraps;
+	bHasReplaySwing = true;
+}
+
+void UGH_CharacterMovementComponent::CallServerMove(const FSavedMove_Character* NewMove, const FSavedMove_Character* OldMove)
+{
+	// Sent first so the server has them when it runs the moves: the old move sent again, the pending move of a dual move, the new move
+	if (GHCharacterOwner != nullptr)
+	{
+		SendSwingMove(OldMove);
+		SendSwingMove(GetPredictionData_Client_Character()->PendingMove.Get());
+		SendSwingMove(NewMove);
+	}
+
+	Super::CallServerMove(NewMove, OldMove);
+}
+
+void UGH_CharacterMovementComponent::SendSwingMove(const FSavedMove_Character* Move)
+{
+	const FGH_SavedMove* SwingMove = static_cast<const FGH_SavedMove*>(Move);
+	if (SwingMove == nullptr || !SwingMove->bSwinging)
+	{
+		return;
+	}
+
+	// Relative to the last move acknowledged by the server, the server keeps the last 128 moves
+	const FGH_SavedMove* AckedMove = static_cast<const FGH_SavedMove*>(GetPredictionData_Client_Character()->LastAckedMove.Get());
+	const bool bRelative = AckedMove != nullptr && AckedMove->bSwinging && (uint8)(SwingMove->SwingMoveId - AckedMove->SwingMoveId) < 128;
+
+	FGH_SwingMoveData Data = FGH_SwingMoveData::Encode(SwingMove->SwingMoveId, SwingMove->Swing, bRelative ? &AckedMove->Swing : nullptr, bRelative ? AckedMove->SwingMoveId : 0);
+	Data.TimeStamp = SwingMove->TimeStamp;
+	AddSwingMoveBits(Data.GetNumBits());
+
+	GHCharacterOwner->ServerSwingMove(Data);
+}
+
+void UGH_CharacterMovementComponent::MoveAutonomous(float ClientTimeStamp, float DeltaTime, uint8 CompressedFlags, const FVector& NewAccel)
+{
+	// The swing the client started this move with. The ones received before it belong to moves already run or dropped
+	bHasClientSwing = false;
+	for (int32 SwingIndex = ReceivedSwings.Num() - 1; SwingIndex >= 0; --SwingIndex)
+	{
+		if (ReceivedSwings[SwingIndex].Key == ClientTimeStamp)
+		{
+			ClientSwing = ReceivedSwings[SwingIndex].Value;
+			bHasClientSwing = true;
+			ReceivedSwings.RemoveAt(0, SwingIndex + 1, false);
+			break;
+		}
+	}
+
+	Super::MoveAutonomous(ClientTimeStamp, DeltaTime, CompressedFlags, NewAccel);
+
+	bHasClientSwing = false;
+}
+
+void UGH_CharacterMovementComponent::ReceiveSwingMove(const FGH_SwingMoveData& Data)
+{
+	AddSwingMoveBits(Data.GetNumBits());
+
+	// The base of a relative move was lost with an unreliable bunch, the server keeps its own swing for this move
+	if (Data.IsRelative() && !SwingHistoryValid[Data.BaseMoveId])
+	{
+		return;
+	}
+
+	const FGH_QuantizedSwing Swing = Data.Decode(Data.IsRelative() ? &SwingHistory[Data.BaseMoveId] : nullptr);
+
+	SwingHistory[Data.MoveId] = Swing;
+	SwingHistoryValid[Data.MoveId] = true;
+	// Ids wrap around, forget the moves the client can no longer be relative to
+	SwingHistoryValid[(uint8)(Data.MoveId + 128)] = false;
+
+	// Kept until the server runs the move, the oldest are dropped when the moves never come
+	if (ReceivedSwings.Num() == MaxReceivedSwings)
+	{
+		ReceivedSwings.RemoveAt(0, 1, false);
+	}
+	ReceivedSwings.Emplace(Data.TimeStamp, Swing);
+}
+
+void UGH_CharacterMovementComponent::AddSwingMoveBits(int32 NumBits)
+{
+	SwingMoveBits += NumBits;
+
+	const float Now = GetWorld()->GetRealTimeSeconds();
+	if (Now - SwingMoveBitsTime >= 1.f)
+	{
+		const float BytesPerSecond = SwingMoveBits / 8.f / (Now - SwingMoveBitsTime);
+		SET_FLOAT_STAT(STAT_GH_SwingMoveBytesPerSecond, BytesPerSecond);
+		CSV_CUSTOM_STAT(Grappling, SwingMoveBytesPerSecond, BytesPerSecond, ECsvCustomStatOp::Set);
+		UE_LOG(LogGHMovement, Verbose, TEXT("%s: swing moves %.1f bytes/s"), *GetNameSafe(PawnOwner), BytesPerSecond);
+
+		SwingMoveBits = 0;
+		SwingMoveBitsTime = Now;
+	}
+}
+
+void UGH_CharacterMovementComponent::SetSwingTarget(const FVector& Location)
+{
+	SwingTarget = Location;
+	bHasSwingTarget = true;
+}
+
+bool UGH_CharacterMovementComponent::IsSwinging() const
+{
+	return MovementMode == MOVE_Custom && CustomMovementMode == (uint8)EGH_CustomMovementMode::Swinging;
+}
+
+void UGH_CharacterMovementComponent::PhysCustom(float deltaTime, int32 Iterations)
+{
+	if (CustomMovementMode == (uint8)EGH_CustomMovementMode::Swinging)
+	{
+		PhysSwinging(deltaTime, Iterations);
+	}
+
+	Super::PhysCustom(deltaTime, Iterations);
+}
+
+void UGH_CharacterMovementComponent::PhysSwinging(float deltaTime, int32 Iterations)
+{
+	GH_SCOPE_CYCLE_COUNTER(PhysSwinging);
+
+	if (deltaTime < MIN_TICK_TIME)
+	{
+		return;
+	}
+
+	// Either the primary rope pendulum or a body hanging from several ropes
+	FGH_PendulumState State;
+	const bool bPendulum = GHCharacterOwner != nullptr && GHCharacterOwner->GetSwingState(State);
+	if (!bPendulum && (GHCharacterOwner == nullptr || !GHCharacterOwner->IsHeldByRopes()))
+	{
+		SetMovementMode(MOVE_Falling);
+		StartNewPhysics(deltaTime, Iterations);
+		return;
+	}
+
+	// The swing manager already advanced the rope this frame. The ropes of networked players, on their client and
+	// on the server, and the moves replayed after a server correction step the pendulum themselves. The server runs
+	// several moves of a client in one frame, each move starts from the state the previous one committed
+	FVector Target = SwingTarget;
+	if ((!bHasSwingTarget || bClientUpdating) && !bPendulum)
+	{
+		// The rope body is not replicated, replayed moves step it from the corrected location and velocity
+		Target = GHCharacterOwner->PredictRopeBodyLocation(deltaTime);
+	}
+	else if (GHCharacterOwner->IsSwingMoveDriven() || bClientUpdating)
+	{
+		FGH_FixedStepPendulum Solver;
+		GHCharacterOwner->GetSwingMove(Solver);
+
+		// A swing saved around other wrap points is not relative to the current pivot
+		if (bClientUpdating && bHasReplaySwing && ReplaySwingNumWraps == GHCharacterOwner->GetNumRopeWraps())
+		{
+			Solver = ReplaySwing;
+		}
+		// The server follows the client swing when close enough to its own
+		else if (bHasClientSwing && CharacterOwner->Role == ROLE_Authority)
+		{
+			FGH_PendulumState ClientState = Solver.State;
+			ClientSwing.ToState(ClientState);
+			GHCharacterOwner->ApplyClientSwing(Solver.State, ClientState, ClientSwing.NumWraps);
+			bHasClientSwing = false;
+		}
+
+		// The fixed steps of the swing manager, interpolated like it does. Any split of the time in moves runs the same steps
+		const FGH_PendulumSettings Settings = GHCharacterOwner->GetSwingSettings();
+		Solver.Advance(Settings, deltaTime);
+		Target = GHCharacterOwner->GetSwingLocation(Solver.State, Solver.GetInterpolatedAngle(Settings));
+
+		if (!bClientUpdating)
+		{
+			GHCharacterOwner->CommitSwingMove(Solver);
+		}
+	}
+	else if (!bHasSwingTarget)
+	{
+		// Not written by the swing manager yet, e.g. locked after it ticked, the character stays on the current pendulum position
+		Target = GHCharacterOwner->GetSwingLocation(State, State.Angle);
+	}
+	bHasSwingTarget = false;
+	bHasReplaySwing = false;
+
+	const FVector OldLocation = UpdatedComponent->GetComponentLocation();
+	const FVector Delta = Target - OldLocation;
+
+	FHitResult Hit(1.f);
+	SafeMoveUpdatedComponent(Delta, UpdatedComponent->GetComponentQuat(), true, Hit);
+
+	const bool bBlocked = Hit.IsValidBlockingHit();
+	if (bBlocked)
+	{
+		HandleImpact(Hit, deltaTime, Delta);
+		SlideAlongSurface(Delta, 1.f - Hit.Time, Hit.Normal, Hit, true);
+	}
+
+	if (!bJustTeleported)
+	{
+		Velocity = (UpdatedComponent->GetComponentLocation() - OldLocation) / deltaTime;
+	}
+
+	if (bBlocked)
+	{
+		ApplySwingImpact(Hit, Delta / deltaTime);
+	}
+
+	// A blocked body restarts the pendulum where it stopped instead of letting it drift away from the body
+	GHCharacterOwner->OnSwingMoved(bBlocked);
+}
@@ -0,0 +1,120 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GH_SwingReplication.h"
+#include "GH_CharacterMovementComponent.generated.h"
+
+class AGH_Character;
+
+/** Custom movement modes of UGH_CharacterMovementComponent, stored in CustomMovementMode */
+UENUM(BlueprintType)
+enum class EGH_CustomMovementMode : uint8
+{
+	None,
+	/** Hanging from the locked ropes, moved along the pendulum or the rope body computed by the swing manager */
+	Swinging
+};
+
+/** How a swing goes on after the character hits the geometry */
+UENUM(BlueprintType)
+enum class EGH_SwingImpact : uint8
+{
+	/** Slides along the surface, the swing goes on from where it stopped */
+	Slide,
+	/** Bounces off the surface, losing part of the speed along its normal */
+	Bounce,
+	/** Lets go of the ropes on a hard impact, slides on the softer ones */
+	Detach
+};
+
+/**
+ * Character movement with a swing mode. While swinging the character is swept towards the position
+ * computed by AGH_SwingManager, so the swing goes through the movement prediction and collision like walking does.
+ */
+UCLASS()
+class GRAPPLINGHOOD_API UGH_CharacterMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+	/** Response to the swing hitting the geometry */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Swinging")
+	EGH_SwingImpact SwingImpact = EGH_SwingImpact::Slide;
+
+	/** Part of the speed along the surface normal kept by a bounce */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Swinging", meta = (ClampMin = "0", ClampMax = "1"))
+	float SwingBounceRestitution = 0.5f;
+
+	/** Speed into the surface the character lets go of its ropes above, with the Detach impact (in cm/s) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Swinging", meta = (ClampMin = "0"))
+	float SwingDetachSpeed = 1200.f;
+
+	/** Sets the location the next swing move goes to, consumed by the next PhysCustom */
+	void SetSwingTarget(const FVector& Location);
+
+	/** Returns whether the character hangs from its rope */
+	bool IsSwinging() const;
+
+	/** Returns the id of a new client swing move */
+	FORCEINLINE uint8 AllocateSwingMoveId() { return ++LastSwingMoveId; }
+
+	/** Sets the swing solver the next replayed move starts from, and the number of wrap points it swings around */
+	void SetReplaySwing(const FGH_FixedStepPendulum& Swing, uint8 NumWraps);
+
+	/** Server side, decodes the swing data sent by the client with one of its moves */
+	void ReceiveSwingMove(const FGH_SwingMoveData& Data);
+
+	virtual void SetUpdatedComponent(USceneComponent* NewUpdatedComponent) override;
+	virtual class FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+
+protected:
+	virtual void PhysCustom(float deltaTime, int32 Iterations) override;
+	virtual void CallServerMove(const class FSavedMove_Character* NewMove, const class FSavedMove_Character* OldMove) override;
+	virtual void MoveAutonomous(float ClientTimeStamp, float DeltaTime, uint8 CompressedFlags, const FVector& NewAccel) override;
+
+	/** Sends the swing data of a client move to the server, nothing if the move was not swinging */
+	void SendSwingMove(const class FSavedMove_Character* Move);
+
+	/** Moves the character along the pendulum, sliding on the geometry it hits */
+	void PhysSwinging(float deltaTime, int32 Iterations);
+
+	/** Applies SwingImpact to the swing blocked by Hit, ImpactVelocity being the velocity the character had before the hit */
+	void ApplySwingImpact(const FHitResult& Hit, const FVector& ImpactVelocity);
+
+	UPROPERTY(Transient)
+	AGH_Character* GHCharacterOwner = nullptr;
+
+	/** Location given by the swing manager this frame */
+	FVector SwingTarget = FVector::ZeroVector;
+	bool bHasSwingTarget = false;
+
+	/** Swing solver of the move being replayed */
+	FGH_FixedStepPendulum ReplaySwing;
+	uint8 ReplaySwingNumWraps = 0;
+	bool bHasReplaySwing = false;
+
+	/** Client side, id of the last swing move */
+	uint8 LastSwingMoveId = 0;
+
+	/** Server side, swing state of the last received moves indexed by move id, to decode the relative ones */
+	FGH_QuantizedSwing SwingHistory[256];
+	bool SwingHistoryValid[256] = {};
+
+	/** Server side, swing states received for the moves not run yet, with the client time stamp of their move */
+	static const int32 MaxReceivedSwings = 16;
+	TArray<TPair<float, FGH_QuantizedSwing>, TInlineAllocator<MaxReceivedSwings>> ReceivedSwings;
+
+	/** Server side, swing state of the client at the start of the move being run */
+	FGH_QuantizedSwing ClientSwing;
+	bool bHasClientSwing = false;
+
+	// Swing data sent or received over the current second
+	int32 SwingMoveBits = 0;
+	float SwingMoveBitsTime = 0.f;
+
+	/** Counts swing data bits and updates the bandwidth stat once per second */
+	void AddSwingMoveBits(int32 NumBits);
+};
@@ -1,15 +1,154 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "GH_Hook.h"
+#include "GrapplingHood.h"
 #include "GameFramework/ProjectileMovementComponent.h"
 #include "Components/SphereComponent.h"
 #include "Components/StaticMeshComponent.h"
 #include "UObject/ConstructorHelpers.h"
 #include "Materials/MaterialInstanceDynamic.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGHHook, Log, All);
+
+DECLARE_CYCLE_STAT(TEXT("Hook tick"), STAT_GH_HookTick, STATGROUP_Grappling);
+DECLARE_CYCLE_STAT(TEXT("Hook fire"), STAT_GH_HookFire, STATGROUP_Grappling);
+DECLARE_CYCLE_STAT(TEXT("Hook retract"), STAT_GH_HookRetract, STATGROUP_Grappling);
+DECLARE_CYCLE_STAT(TEXT("Hook hit"), STAT_GH_HookHit, STATGROUP_Grappling);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Active hooks"), STAT_GH_ActiveHooks, STATGROUP_Grappling);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Retracts/s"), STAT_GH_RetractsPerSecond, STATGROUP_Grappling);
+
+/** Allowed transitions, indexed by [From][To]. Any state goes back to DOCKED when the hook is reset by its pool */
+static const bool GHookTransitions[AGH_Hook::HOOKSTATE_NUM][AGH_Hook::HOOKSTATE_NUM] =
+{
+	//					DOCKED	FIRING	HOOKED	RETRACTING
+	/* DOCKED */		{ false,	true,	false,	false },
+	/* FIRING */		{ true,		false,	true,	true },
+	/* HOOKED */		{ true,		false,	false,	true },
+	/* RETRACTING */	{ true,		false,	false,	false },
+};
+
+/** Latest transitions of the hooks of a world, dumped by gh.Hook.DumpTransitions */
+struct FGH_HookTransitionTrace
+{
+	struct FRecord
+	{
+		double Time;
+		FName Hook;
+		AGH_Hook::State From;
+		AGH_Hook::State To;
+		/** Time spent in the state left (in s) */
+		float Duration;
+	};
+
+	static const int32 Capacity = 1024;
+
+	TArray<FRecord> Records;
+	/** Index of the oldest record once the buffer is full */
+	int32 NextRecord = 0;
+
+	// Time spent in each state since the start, not limited by the buffer capacity
+	double TotalTime[AGH_Hook::HOOKSTATE_NUM] = {};
+	int32 NumExits[AGH_Hook::HOOKSTATE_NUM] = {};
+
+	void Add(double Time, FName Hook, AGH_Hook::State From, AGH_Hook::State To, float Duration)
+	{
+		const FRecord Record = { Time, Hook, From, To, Duration };
+		if (Records.Num() < Capacity)
+		{
+			Records.Reserve(Capacity);
+			Records.Add(Record);
+		}
+		else
+		{
+			Records[NextRecord] = Record;
+			NextRecord = (NextRecord + 1) % Capacity;
+		}
+
+		TotalTime[From] += Duration;
+		++NumExits[From];
+	}
+
+	void Dump(FOutputDevice& Ar) const
+	{
+		Ar.Logf(TEXT("Last %d hook transitions:"), Records.Num());
+		for (int32 Offset = 0; Offset < Records.Num(); ++Offset)
+		{
+			const FRecord& Record = Records[(NextRecord + Offset) % Records.Num()];
+			Ar.Logf(TEXT("  %.4f %s %s -> %s (%.3f s)"), Record.Time, *Record.Hook.ToString(), AGH_Hook::GetStateName(Record.From), AGH_Hook::GetStateName(Record.To), Record.Duration);
+		}
+
+		Ar.Logf(TEXT("Time per hook state:"));
+		for (int32 HookState = 0; HookState < AGH_Hook::HOOKSTATE_NUM; ++HookState)
+		{
+			const double Average = NumExits[HookState] > 0 ? TotalTime[HookState] / NumExits[HookState] : 0.0;
+			Ar.Logf(TEXT("  %-10s %6d exits, %.3f s total, %.3f s average"), AGH_Hook::GetStateName(static_cast<AGH_Hook::State>(HookState)), NumExits[HookState], TotalTime[HookState], Average);
+		}
+	}
+};
+
+/** Transition traces of each world, PIE clients and the server do not mix their hooks */
+static TMap<const UWorld*, FGH_HookTransitionTrace> GHookTransitionTraces;
+
+static FGH_HookTransitionTrace& GetHookTransitionTrace(const UWorld* World)
+{
+	// The trace of a world goes away with it, a new world may reuse the address
+	static const FDelegateHandle CleanupHandle = FWorldDelegates::OnWorldCleanup.AddLambda([](UWorld* CleanedWorld, bool, bool)
+	{
+		GHookTransitionTraces.Remove(CleanedWorld);
+	});
+
+	return GHookTransitionTraces.FindOrAdd(World);
+}
+
+/** Retracts started by every hook, published once per second */
+struct FGH_RetractRate
+{
+	int32 NumRetracts = 0;
+	double WindowStart = 0.0;
+
+	void Update(double Now, bool bRetractStarted)
+	{
+		NumRetracts += bRetractStarted ? 1 : 0;
+
+		const double Elapsed = Now - WindowStart;
+		if (Elapsed >= 1.0)
+		{
+			const float RetractsPerSecond = WindowStart > 0.0 ? static_cast<float>(NumRetracts / Elapsed) : 0.f;
+			SET_FLOAT_STAT(STAT_GH_RetractsPerSecond, RetractsPerSecond);
+			CSV_CUSTOM_STAT(Grappling, RetractsPerSecond, RetractsPerSecond, ECsvCustomStatOp::Set);
+
+			NumRetracts = 0;
+			WindowStart = Now;
+		}
+	}
+};
+
+static FGH_RetractRate GHookRetractRate;
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice DumpHookTransitionsCommand(
+	TEXT("gh.Hook.DumpTransitions"),
+	TEXT("Logs the latest hook state transitions of the world and the time spent in each state."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (const FGH_HookTransitionTrace* Trace = GHookTransitionTraces.Find(World))
+		{
+			Trace->Dump(Ar);
+		}
+		else
+		{
+			Ar.Logf(TEXT("No hook transition in %s"), World != nullptr ? *World->GetName() : TEXT("this world"));
+		}
+	}));
 
 // Sets default values
 AGH_Hook::AGH_Hook()
 {
+	// Only ticks while travelling to a predicted impact
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
 	// Use a sphere as a simple collision representation
 	SphereCollider = CreateDefaultSubobject<USphereComponent>(TEXT("SphereComp"));
 	SphereCollider->InitSphereRadius(5.0f);
@@ -43,6 +182,7 @@ AGH_Hook::AGH_Hook()
 	ProjectileMovement->bShouldBounce = true;
 
 	HookState = DOCKED;
+	StateEnterTime = FPlatformTime::Seconds();
 
 	InitialLifeSpan = 0.f;
 }
@@ -54,14 +194,109 @@ AGH_Hook::~AGH_Hook()
 
 void AGH_Hook::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
 {
+	GH_SCOPE_CYCLE_COUNTER(HookHit);
+
 	// Only add impulse and destroy projectile if we hit a physics
 	if (HookState == FIRING && (OtherActor != NULL) && (OtherActor != this) && (OtherComp != NULL))
 	{
 		ProjectileMovement->Deactivate();
-		HookState = HOOKED;
+		AttachToAnchor(OtherComp);
+		TransitionTo(HOOKED);
+	}
+}
+
+void AGH_Hook::AttachToAnchor(UPrimitiveComponent* Component)
+{
+	// Static and stationary components never move, the hook stays in world space
+	if (Component == nullptr || Component->Mobility != EComponentMobility::Movable)
+	{
+		return;
+	}
+
+	AnchorComponent = Component;
+	DetachedCollision = SphereCollider->GetCollisionEnabled();
+	SphereCollider->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	AttachToComponent(Component, FAttachmentTransformRules::KeepWorldTransform);
+	bAttachedToAnchor = true;
+}
+
+void AGH_Hook::DetachFromAnchor()
+{
+	// Docked hooks are attached to the gun, not to an anchor
+	if (!bAttachedToAnchor)
+	{
+		return;
+	}
+
+	DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+	SphereCollider->SetCollisionEnabled(DetachedCollision);
+	AnchorComponent.Reset();
+	bAttachedToAnchor = false;
+}
+
+bool AGH_Hook::IsOnMovingAnchor() const
+{
+	return HookState == HOOKED && AnchorComponent.IsValid();
+}
+
+FVector AGH_Hook::GetAnchorVelocity() const
+{
+	return AnchorComponent.IsValid() ? AnchorComponent->GetComponentVelocity() : FVector::ZeroVector;
+}
+
+bool AGH_Hook::IsTransitionAllowed(State From, State To)
+{
+	return From < HOOKSTATE_NUM && To < HOOKSTATE_NUM && GHookTransitions[From][To];
+}
+
+const TCHAR* AGH_Hook::GetStateName(State InState)
+{
+	switch (InState)
+	{
+	case DOCKED:		return TEXT("DOCKED");
+	case FIRING:		return TEXT("FIRING");
+	case HOOKED:		return TEXT("HOOKED");
+	case RETRACTING:	return TEXT("RETRACTING");
+	default:			return TEXT("INVALID");
 	}
 }
 
+bool AGH_Hook::TransitionTo(State NewState)
+{
+	if (NewState == HookState)
+	{
+		return false;
+	}
+
+	if (!IsTransitionAllowed(HookState, NewState))
+	{
+		UE_LOG(LogGHHook, Warning, TEXT("%s: transition from %s to %s refused"), *GetName(), GetStateName(HookState), GetStateName(NewState));
+		return false;
+	}
+
+	const State PreviousState = HookState;
+	const double Now = FPlatformTime::Seconds();
+	GetHookTransitionTrace(GetWorld()).Add(Now, GetFName(), PreviousState, NewState, static_cast<float>(Now - StateEnterTime));
+	GHookRetractRate.Update(Now, NewState == RETRACTING);
+
+	// Every state but DOCKED has the hook out of the gun
+	if (PreviousState == DOCKED)
+	{
+		INC_DWORD_STAT(STAT_GH_ActiveHooks);
+	}
+	else if (NewState == DOCKED)
+	{
+		DEC_DWORD_STAT(STAT_GH_ActiveHooks);
+	}
+
+	StateExitEvent.Broadcast(this, PreviousState);
+	HookState = NewState;
+	StateEnterTime = Now;
+	StateEnterEvent.Broadcast(this, NewState);
+	StateChangedEvent.Broadcast(this, PreviousState, NewState);
+	return true;
+}
+
 void AGH_Hook::StopAllMovement()
 {
 	ProjectileMovement->Deactivate();
@@ -69,20 +304,32 @@ void AGH_Hook::StopAllMovement()
 
 void AGH_Hook::Fire(FVector direction)
 {
-	if (HookState == DOCKED)
+	GH_SCOPE_CYCLE_COUNTER(HookFire);
+
+	if (IsTransitionAllowed(HookState, FIRING))
 	{
-		ProjectileMovement->Activate();
-		ProjectileMovement->SetVelocityInLocalSpace(GetTransform().InverseTransformVector((direction != FVector::ZeroVector ? direction : GetActorForwardVector()) * FireSpeed));
-		HookState = FIRING;
+		const FVector Velocity = (direction != FVector::ZeroVector ? direction : GetActorForwardVector()) * FireSpeed;
+		TransitionTo(FIRING);
+
+		if (!bPredictiveFire || !FirePredictive(Velocity))
+		{
+			ProjectileMovement->Activate();
+			ProjectileMovement->SetVelocityInLocalSpace(GetTransform().InverseTransformVector(Velocity));
+		}
 	}
 }
 
 void AGH_Hook::Retract(FVector destination, float deltaTime)
 {
-	if (HookState == FIRING || HookState == HOOKED)
+	GH_SCOPE_CYCLE_COUNTER(HookRetract);
+
+	if (IsTransitionAllowed(HookState, RETRACTING))
 	{
+		DetachFromAnchor();
 		StopAllMovement();
-		HookState = RETRACTING;
+		bPredictiveTravel = false;
+		SetActorTickEnabled(false);
+		TransitionTo(RETRACTING);
 	}
 
 	if (HookState == RETRACTING)
@@ -93,7 +340,7 @@ void AGH_Hook::Retract(FVector destination, float deltaTime)
 		if ((distanceThisFrame * distanceThisFrame) > DeltaToDestination.SizeSquared())
 		{
 			SetActorLocation(destination);
-			HookState = DOCKED;
+			TransitionTo(DOCKED);
 			return;
 		}
 		else if(deltaTime != 0.f)
@@ -104,3 +351,108 @@ void AGH_Hook::Retract(FVector destination, float deltaTime)
 	}
 }
 
+
+void AGH_Hook::HookAt(const FVector& Location, UPrimitiveComponent* Component)
+{
+	if (IsTransitionAllowed(HookState, HOOKED))
+	{
+		StopAllMovement();
+		bPredictiveTravel = false;
+		SetActorTickEnabled(false);
+		SetActorLocation(Location);
+		AttachToAnchor(Component);
+		TransitionTo(HOOKED);
+	}
+}
+
+bool AGH_Hook::FirePredictive(const FVector& Velocity)
+{
+	// The projectile movement clamps the launch speed, travel at the same speed
+	const float Speed = ProjectileMovement->GetMaxSpeed() > 0.f ? FMath::Min(Velocity.Size(), ProjectileMovement->GetMaxSpeed()) : Velocity.Size();
+	if (Speed <= KINDA_SMALL_NUMBER)
+	{
+		return false;
+	}
+
+	const FVector Start = GetActorLocation();
+	const FVector End = Start + Velocity.GetSafeNormal() * PredictiveFireRange;
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(HookPredictiveFire), false, this);
+	QueryParams.AddIgnoredActor(GetOwner());
+
+	FHitResult Hit;
+	if (!GetWorld()->SweepSingleByProfile(Hit, Start, End, FQuat::Identity, SphereCollider->GetCollisionProfileName(), FCollisionShape::MakeSphere(SphereCollider->GetScaledSphereRadius()), QueryParams))
+	{
+		return false;
+	}
+
+	// Moving targets may not be there when the hook arrives, simulate those
+	const UPrimitiveComponent* HitComponent = Hit.GetComponent();
+	if (HitComponent == nullptr || HitComponent->Mobility == EComponentMobility::Movable || HitComponent->IsSimulatingPhysics())
+	{
+		return false;
+	}
+
+	bPredictiveTravel = true;
+	TravelStart = Start;
+	TravelEnd = Hit.Location;
+	TravelDuration = (TravelEnd - TravelStart).Size() / Speed;
+	TravelElapsed = 0.f;
+	SetActorRotation(Velocity.Rotation());
+	SetActorTickEnabled(true);
+	return true;
+}
+
+void AGH_Hook::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Destroyed out of the gun (level unload, end of play), the hook never transitions back to DOCKED
+	if (HookState != DOCKED)
+	{
+		DEC_DWORD_STAT(STAT_GH_ActiveHooks);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AGH_Hook::Tick(float DeltaSeconds)
+{
+	GH_SCOPE_CYCLE_COUNTER(HookTick);
+	FGH_ScopedFrameCycles FrameCycles(FGH_FrameCounters::Get().HookTickCycles);
+
+	Super::Tick(DeltaSeconds);
+
+	if (!bPredictiveTravel || HookState != FIRING)
+	{
+		SetActorTickEnabled(false);
+		return;
+	}
+
+	TravelElapsed += DeltaSeconds;
+	if (TravelElapsed >= TravelDuration)
+	{
+		SetActorLocation(TravelEnd);
+		bPredictiveTravel = false;
+		SetActorTickEnabled(false);
+		TransitionTo(HOOKED);
+	}
+	else
+	{
+		SetActorLocation(FMath::Lerp(TravelStart, TravelEnd, TravelElapsed / TravelDuration));
+	}
+}
+
+void AGH_Hook::OnAcquiredFromPool(AGH_ActorPool* Pool)
+{
+	DetachFromAnchor();
+	StopAllMovement();
+	bPredictiveTravel = false;
+	TransitionTo(DOCKED);
+}
+
+void AGH_Hook::OnReleasedToPool()
+{
+	DetachFromAnchor();
+	StopAllMovement();
+	bPredictiveTravel = false;
+	TransitionTo(DOCKED);
+}
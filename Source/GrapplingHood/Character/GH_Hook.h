@@ -4,10 +4,11 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "GH_ActorPool.h"
 #include "GH_Hook.generated.h"
 
 UCLASS()
-class GRAPPLINGHOOD_API AGH_Hook : public AActor
+class GRAPPLINGHOOD_API AGH_Hook : public AActor, public IGH_Poolable
 {
 	GENERATED_BODY()
 	
@@ -31,6 +32,14 @@ class GRAPPLINGHOOD_API AGH_Hook : public AActor
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Projectile, meta = (AllowPrivateAccess = "true"))
 	float RetractSpeed = 10000.f;
 
+	/** Traces the hook path once when fired and moves it to the impact without simulation when the target is static */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Projectile, meta = (AllowPrivateAccess = "true"))
+	bool bPredictiveFire = true;
+
+	/** Length of the trace done when fired predictively, farther targets use the projectile simulation */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Projectile, meta = (AllowPrivateAccess = "true", EditCondition = "bPredictiveFire"))
+	float PredictiveFireRange = 10000.f;
+
 public:
 
 	enum State {
@@ -41,6 +50,18 @@ public:
 		HOOKSTATE_NUM
 	};
 
+	/** Broadcast with the previous and the new state each time the hook changes state */
+	DECLARE_EVENT_ThreeParams(AGH_Hook, FStateChangedEvent, AGH_Hook*, State, State);
+
+	/** Broadcast with the state entered or left */
+	DECLARE_EVENT_TwoParams(AGH_Hook, FStateEvent, AGH_Hook*, State);
+
+	/** Returns whether the transition table allows going from one state to the other */
+	static bool IsTransitionAllowed(State From, State To);
+
+	/** Returns the name of a state, for logs and traces */
+	static const TCHAR* GetStateName(State InState);
+
 	// Sets default values for this actor's properties
 	AGH_Hook();
 
@@ -60,14 +81,75 @@ public:
 	UFUNCTION()
 	void Retract(FVector destination, float deltaTime);
 
+	/** Ends the flight at the given location, on the given component if any, used when the server decided where the hook attached */
+	void HookAt(const FVector& Location, UPrimitiveComponent* Component = nullptr);
+
+	/** Returns whether the hook is attached to a component that can move */
+	bool IsOnMovingAnchor() const;
+
+	/** Returns the velocity of the component the hook is attached to, zero when it does not move */
+	FVector GetAnchorVelocity() const;
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// IGH_Poolable interface
+	virtual void OnAcquiredFromPool(AGH_ActorPool* Pool) override;
+	virtual void OnReleasedToPool() override;
+	// End of IGH_Poolable interface
+
 	/** Returns CollisionComp subobject **/
 	FORCEINLINE class USphereComponent* GetCollisionComp() const { return SphereCollider; }
 	/** Returns ProjectileMovement subobject **/
 	FORCEINLINE class UProjectileMovementComponent* GetProjectileMovement() const { return ProjectileMovement; }
 	/** Returns State of the Hook **/
 	FORCEINLINE State GetState() const { return HookState; }
+	/** Returns the event broadcast on state changes **/
+	FORCEINLINE FStateChangedEvent& OnStateChanged() { return StateChangedEvent; }
+	/** Returns the event broadcast when a state is entered **/
+	FORCEINLINE FStateEvent& OnStateEnter() { return StateEnterEvent; }
+	/** Returns the event broadcast when a state is left **/
+	FORCEINLINE FStateEvent& OnStateExit() { return StateExitEvent; }
+	/** Returns the movable component the hook is attached to, null when hooked to the static world **/
+	FORCEINLINE UPrimitiveComponent* GetAnchorComponent() const { return AnchorComponent.Get(); }
+	/** Returns the time spent in the current state (in s) **/
+	FORCEINLINE float GetTimeInState() const { return static_cast<float>(FPlatformTime::Seconds() - StateEnterTime); }
 
 private :
 	State HookState;
 
+	FStateChangedEvent StateChangedEvent;
+	FStateEvent StateEnterEvent;
+	FStateEvent StateExitEvent;
+
+	/** Time the current state was entered at */
+	double StateEnterTime = 0.0;
+
+	/** Changes the state if the transition table allows it, notifies the listeners and records the transition */
+	bool TransitionTo(State NewState);
+
+	/** Traces the fire path, returns true when the hook can travel to a static impact without simulation */
+	bool FirePredictive(const FVector& Velocity);
+
+	/** Follows the hit component once hooked when it can move, platforms and simulating bodies */
+	void AttachToAnchor(UPrimitiveComponent* Component);
+
+	/** Leaves the component the hook is attached to */
+	void DetachFromAnchor();
+
+	/** Movable component the hook is attached to */
+	TWeakObjectPtr<UPrimitiveComponent> AnchorComponent;
+	bool bAttachedToAnchor = false;
+
+	/** Collision of the hook before it was attached, the hook does not collide with its anchor */
+	TEnumAsByte<ECollisionEnabled::Type> DetachedCollision = ECollisionEnabled::QueryAndPhysics;
+
+	/** Whether the hook is moving to a precomputed impact */
+	bool bPredictiveTravel = false;
+	FVector TravelStart;
+	FVector TravelEnd;
+	float TravelDuration = 0.f;
+	float TravelElapsed = 0.f;
+
 };
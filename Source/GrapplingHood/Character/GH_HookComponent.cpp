@@ -6,6 +6,9 @@
 // Sets default values for this component's properties
 UGH_HookComponent::UGH_HookComponent()
 {
+	// Nothing to update per frame
+	PrimaryComponentTick.bCanEverTick = false;
+
 	// Create a CameraComponent	
 	//SphereCollider = CreateDefaultSubobject<USphereComponent>(TEXT("Collider"));
 	//SphereCollider->SetRelativeLocation(FVector::ZeroVector);
@@ -22,12 +25,3 @@ void UGH_HookComponent::BeginPlay()
 	
 }
 
-
-// Called every frame
-void UGH_HookComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
-{
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
-
-	// ...
-}
-
@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GH_HookTargeting.h"
+#include "GH_Character.h"
+#include "GrapplingHood.h"
+#include "Camera/CameraComponent.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Targeting traces"), STAT_GH_TargetingTraces, STATGROUP_Grappling);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Targeting cache hits"), STAT_GH_TargetingCacheHits, STATGROUP_Grappling);
+
+// Sets default values
+AGH_HookTargeting::AGH_HookTargeting()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = true;
+	// Issue the traces once the cameras moved so they run during the rest of the frame
+	PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+}
+
+AGH_HookTargeting* AGH_HookTargeting::Get(UWorld* World)
+{
+	if (World == nullptr)
+	{
+		return nullptr;
+	}
+
+	for (TActorIterator<AGH_HookTargeting> It(World); It; ++It)
+	{
+		return *It;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.ObjectFlags |= RF_Transient;
+	return World->SpawnActor<AGH_HookTargeting>(SpawnParams);
+}
+
+void AGH_HookTargeting::RegisterCharacter(AGH_Character* Character)
+{
+	if (FindTarget(Character) == nullptr)
+	{
+		FTargetingEntry& Entry = Entries[Entries.AddDefaulted()];
+		Entry.Character = Character;
+	}
+}
+
+void AGH_HookTargeting::UnregisterCharacter(AGH_Character* Character)
+{
+	Entries.RemoveAllSwap([Character](const FTargetingEntry& Entry) { return Entry.Character == Character; });
+}
+
+const FGH_HookTarget* AGH_HookTargeting::FindTarget(const AGH_Character* Character) const
+{
+	const FTargetingEntry* Entry = Entries.FindByPredicate([Character](const FTargetingEntry& Candidate) { return Candidate.Character == Character; });
+	return Entry != nullptr ? &Entry->Target : nullptr;
+}
+
+void AGH_HookTargeting::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	UWorld* const World = GetWorld();
+	const float Now = World->GetTimeSeconds();
+	const float CacheDistanceSquared = FMath::Square(CacheDistance);
+	const float CacheCosAngle = FMath::Cos(FMath::DegreesToRadians(CacheAngle));
+
+	int32 NumTraces = 0;
+	int32 NumCacheHits = 0;
+
+	for (int32 EntryIndex = Entries.Num() - 1; EntryIndex >= 0; --EntryIndex)
+	{
+		FTargetingEntry& Entry = Entries[EntryIndex];
+		AGH_Character* Character = Entry.Character.Get();
+		if (Character == nullptr)
+		{
+			Entries.RemoveAtSwap(EntryIndex, 1, false);
+			continue;
+		}
+
+		// Results of the trace issued last frame
+		if (Entry.PendingTrace.IsValid() && World->IsTraceHandleValid(Entry.PendingTrace, false))
+		{
+			FTraceDatum TraceDatum;
+			if (World->QueryTraceData(Entry.PendingTrace, TraceDatum))
+			{
+				const FHitResult* Hit = TraceDatum.OutHits.FindByPredicate([](const FHitResult& Candidate) { return Candidate.bBlockingHit; });
+				Entry.Target.bValid = Hit != nullptr;
+				Entry.Target.Location = Hit != nullptr ? Hit->ImpactPoint : FVector::ZeroVector;
+				Entry.Target.Normal = Hit != nullptr ? Hit->ImpactNormal : FVector::ZeroVector;
+				Entry.Target.Component = Hit != nullptr ? Hit->GetComponent() : nullptr;
+				Entry.PendingTrace = FTraceHandle();
+			}
+			else
+			{
+				// Still running, wait for it
+				continue;
+			}
+		}
+
+		// Only the players looking through the camera need the preview
+		if (!Character->IsLocallyControlled())
+		{
+			continue;
+		}
+
+		const FVector ViewLocation = Character->GetCamera()->GetComponentLocation();
+		const FVector ViewDirection = Character->GetCamera()->GetForwardVector();
+
+		if (FVector::DistSquared(ViewLocation, Entry.TracedLocation) <= CacheDistanceSquared
+			&& FVector::DotProduct(ViewDirection, Entry.TracedDirection) >= CacheCosAngle
+			&& Now - Entry.TracedTime <= CacheMaxAge)
+		{
+			++NumCacheHits;
+			continue;
+		}
+
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(HookTargeting), false, Character);
+		for (AGH_Hook* CharacterHook : Character->GetHooks())
+		{
+			QueryParams.AddIgnoredActor(CharacterHook);
+		}
+		Entry.PendingTrace = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, ViewLocation, ViewLocation + ViewDirection * TraceRange, TraceChannel, QueryParams);
+		Entry.TracedLocation = ViewLocation;
+		Entry.TracedDirection = ViewDirection;
+		Entry.TracedTime = Now;
+		++NumTraces;
+	}
+
+	SET_DWORD_STAT(STAT_GH_TargetingTraces, NumTraces);
+	SET_DWORD_STAT(STAT_GH_TargetingCacheHits, NumCacheHits);
+}
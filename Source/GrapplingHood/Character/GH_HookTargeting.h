@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "WorldCollision.h"
+#include "GH_HookTargeting.generated.h"
+
+class AGH_Character;
+
+/** Where the hook of a character would attach if fired now */
+struct FGH_HookTarget
+{
+	bool bValid = false;
+	FVector Location = FVector::ZeroVector;
+	FVector Normal = FVector::ZeroVector;
+	TWeakObjectPtr<UPrimitiveComponent> Component;
+};
+
+/**
+ * World-level service previewing the hook attach point of the locally controlled characters.
+ * Traces are issued in one batch through the async trace API and read back the next frame,
+ * and skipped while the camera stays close to the view of the last trace.
+ */
+UCLASS(config = Game, notplaceable)
+class GRAPPLINGHOOD_API AGH_HookTargeting : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	AGH_HookTargeting();
+
+	/** Returns the targeting service of the world, spawning it on first use */
+	static AGH_HookTargeting* Get(UWorld* World);
+
+	/** Length of the targeting traces (in cm) */
+	UPROPERTY(EditAnywhere, Config, Category = Targeting)
+	float TraceRange = 10000.f;
+
+	/** Channel of the targeting traces */
+	UPROPERTY(EditAnywhere, Config, Category = Targeting)
+	TEnumAsByte<ECollisionChannel> TraceChannel = ECC_Visibility;
+
+	/** Camera move under which the last result is reused (in cm) */
+	UPROPERTY(EditAnywhere, Config, Category = Targeting)
+	float CacheDistance = 5.f;
+
+	/** Camera rotation under which the last result is reused (in degrees) */
+	UPROPERTY(EditAnywhere, Config, Category = Targeting)
+	float CacheAngle = 0.5f;
+
+	/** Age after which a result is traced again even if the camera did not move (in s) */
+	UPROPERTY(EditAnywhere, Config, Category = Targeting)
+	float CacheMaxAge = 0.5f;
+
+	/** Starts previewing the hook target of the character */
+	void RegisterCharacter(AGH_Character* Character);
+
+	/** Stops previewing the hook target of the character */
+	void UnregisterCharacter(AGH_Character* Character);
+
+	/** Returns the last known hook target of the character, null if not registered */
+	const FGH_HookTarget* FindTarget(const AGH_Character* Character) const;
+
+	virtual void Tick(float DeltaSeconds) override;
+
+protected:
+	/** Targeting state of one character */
+	struct FTargetingEntry
+	{
+		TWeakObjectPtr<AGH_Character> Character;
+		FGH_HookTarget Target;
+		FTraceHandle PendingTrace;
+		FVector TracedLocation = FVector::ZeroVector;
+		FVector TracedDirection = FVector::ZeroVector;
+		float TracedTime = -MAX_flt;
+	};
+
+	TArray<FTargetingEntry> Entries;
+};
@@ -0,0 +1,140 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GH_MuzzleAnchor.h"
+#include "GH_Character.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/SkeletalMeshSocket.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+
+FGH_MuzzleAnchor::~FGH_MuzzleAnchor()
+{
+	Reset();
+}
+
+void FGH_MuzzleAnchor::Resolve(USkeletalMeshComponent* InMesh, FName SocketName)
+{
+	Reset();
+
+	Mesh = InMesh;
+	if (InMesh == nullptr)
+	{
+		return;
+	}
+
+	const USkeletalMeshSocket* Socket = InMesh->GetSocketByName(SocketName);
+	if (Socket != nullptr)
+	{
+		BoneIndex = InMesh->GetBoneIndex(Socket->BoneName);
+		SocketTransform = FTransform(Socket->RelativeRotation, Socket->RelativeLocation, Socket->RelativeScale);
+	}
+
+	TransformUpdatedHandle = InMesh->TransformUpdated.AddRaw(this, &FGH_MuzzleAnchor::OnMeshTransformUpdated);
+}
+
+void FGH_MuzzleAnchor::Reset()
+{
+	if (USkeletalMeshComponent* OldMesh = Mesh.Get())
+	{
+		OldMesh->TransformUpdated.Remove(TransformUpdatedHandle);
+	}
+
+	Mesh.Reset();
+	BoneIndex = INDEX_NONE;
+	SocketTransform = FTransform::Identity;
+	TransformUpdatedHandle.Reset();
+	Invalidate();
+}
+
+void FGH_MuzzleAnchor::OnMeshTransformUpdated(USceneComponent* Component, EUpdateTransformFlags Flags, ETeleportType Teleport)
+{
+	Invalidate();
+}
+
+const FTransform& FGH_MuzzleAnchor::GetWorldTransform() const
+{
+	// The bones may be animated, the transform is also computed again on each frame
+	if (CachedFrame == GFrameCounter)
+	{
+		return WorldTransform;
+	}
+
+	const USkeletalMeshComponent* MeshComponent = Mesh.Get();
+	if (MeshComponent == nullptr)
+	{
+		return FTransform::Identity;
+	}
+
+	WorldTransform = BoneIndex != INDEX_NONE ? SocketTransform * MeshComponent->GetBoneTransform(BoneIndex) : MeshComponent->GetComponentTransform();
+	CachedFrame = GFrameCounter;
+	return WorldTransform;
+}
+
+/** Compares the muzzle reads of every grappling character through the socket search and through the cached anchor */
+static void BenchmarkMuzzle(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+{
+	const int32 Iterations = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 1000;
+	static const FName MuzzleSocketName(TEXT("Muzzle"));
+
+	TArray<AGH_Character*> Characters;
+	for (TActorIterator<AGH_Character> It(World); It; ++It)
+	{
+		if (It->GetGunMesh() != nullptr && It->GetGunMesh()->GetSocketByName(MuzzleSocketName) != nullptr)
+		{
+			Characters.Add(*It);
+		}
+	}
+
+	if (Characters.Num() == 0)
+	{
+		Ar.Logf(TEXT("No grappling character with a muzzle socket in the world"));
+		return;
+	}
+
+	// Summed so the reads are not optimized away
+	FVector Sum = FVector::ZeroVector;
+
+	uint32 StartCycles = FPlatformTime::Cycles();
+	for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+	{
+		for (const AGH_Character* Character : Characters)
+		{
+			Sum += Character->GetGunMesh()->GetSocketByName(MuzzleSocketName)->GetSocketLocation(Character->GetGunMesh());
+		}
+	}
+	const uint32 SocketSearchCycles = FPlatformTime::Cycles() - StartCycles;
+
+	StartCycles = FPlatformTime::Cycles();
+	for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+	{
+		for (AGH_Character* Character : Characters)
+		{
+			Character->GetMuzzleAnchor().Invalidate();
+			Sum += Character->GetMuzzleWorldLocation();
+		}
+	}
+	const uint32 ResolvedCycles = FPlatformTime::Cycles() - StartCycles;
+
+	StartCycles = FPlatformTime::Cycles();
+	for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+	{
+		for (const AGH_Character* Character : Characters)
+		{
+			Sum += Character->GetMuzzleWorldLocation();
+		}
+	}
+	const uint32 CachedCycles = FPlatformTime::Cycles() - StartCycles;
+
+	const double NumReads = (double)Iterations * Characters.Num();
+	Ar.Logf(TEXT("Muzzle reads over %d characters x %d iterations (checksum %.1f):"), Characters.Num(), Iterations, Sum.Size());
+	Ar.Logf(TEXT("  socket search   %8.1f ns/read"), FPlatformTime::ToMilliseconds(SocketSearchCycles) * 1.e6 / NumReads);
+	Ar.Logf(TEXT("  resolved socket %8.1f ns/read"), FPlatformTime::ToMilliseconds(ResolvedCycles) * 1.e6 / NumReads);
+	Ar.Logf(TEXT("  cached frame    %8.1f ns/read"), FPlatformTime::ToMilliseconds(CachedCycles) * 1.e6 / NumReads);
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice BenchmarkMuzzleCommand(
+	TEXT("gh.Muzzle.Benchmark"),
+	TEXT("Times the muzzle location reads of every grappling character, by socket search and through the cached muzzle anchor.\n")
+	TEXT("Usage: gh.Muzzle.Benchmark [Iterations=1000]"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic(&BenchmarkMuzzle));
@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SceneComponent.h"
+
+class USkeletalMeshComponent;
+
+/**
+ * Socket of a skeletal mesh resolved once, the bone index and socket transform are kept
+ * so reading the socket no longer searches the socket list by name.
+ * The world transform is cached, and computed again on a new frame or when the mesh moves.
+ */
+class GRAPPLINGHOOD_API FGH_MuzzleAnchor
+{
+public:
+	~FGH_MuzzleAnchor();
+
+	/** Finds the socket on the mesh and starts following the mesh moves, the mesh transform is used if the socket is missing */
+	void Resolve(USkeletalMeshComponent* InMesh, FName SocketName);
+
+	/** Stops following the mesh */
+	void Reset();
+
+	/** Whether the socket was found on the mesh */
+	FORCEINLINE bool IsResolved() const { return BoneIndex != INDEX_NONE; }
+
+	/** Socket transform in world space */
+	const FTransform& GetWorldTransform() const;
+
+	FORCEINLINE FVector GetWorldLocation() const { return GetWorldTransform().GetLocation(); }
+
+	/** Socket location relative to its bone */
+	FORCEINLINE FVector GetRelativeLocation() const { return SocketTransform.GetLocation(); }
+
+	/** Forces the next read to compute the world transform */
+	FORCEINLINE void Invalidate() const { CachedFrame = MAX_uint64; }
+
+private:
+	void OnMeshTransformUpdated(USceneComponent* Component, EUpdateTransformFlags Flags, ETeleportType Teleport);
+
+	TWeakObjectPtr<USkeletalMeshComponent> Mesh;
+	int32 BoneIndex = INDEX_NONE;
+	FTransform SocketTransform = FTransform::Identity;
+	FDelegateHandle TransformUpdatedHandle;
+
+	mutable FTransform WorldTransform = FTransform::Identity;
+	/** Frame the world transform was computed in */
+	mutable uint64 CachedFrame = MAX_uint64;
+};
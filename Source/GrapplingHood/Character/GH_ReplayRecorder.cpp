@@ -0,0 +1,433 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GH_ReplayRecorder.h"
+#include "GH_Character.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGHReplay, Log, All);
+
+/** File tag and version of the replay files */
+static const uint32 GHReplayMagic = 0x50524847; // GHRP
+static const uint32 GHReplayVersion = 2;
+
+enum EGH_ReplayFrameField : uint8
+{
+	GH_REPLAYFIELD_MoveForward = 1 << 0,
+	GH_REPLAYFIELD_MoveRight = 1 << 1,
+	GH_REPLAYFIELD_Turn = 1 << 2,
+	GH_REPLAYFIELD_LookUp = 1 << 3,
+	GH_REPLAYFIELD_Buttons = 1 << 4,
+	GH_REPLAYFIELD_Swing = 1 << 5,
+	GH_REPLAYFIELD_Reel = 1 << 6
+};
+
+FArchive& operator<<(FArchive& Ar, FGH_ReplayFrame& Frame)
+{
+	uint8 Fields = 0;
+	if (Ar.IsSaving())
+	{
+		Fields |= Frame.MoveForward != 0.f ? GH_REPLAYFIELD_MoveForward : 0;
+		Fields |= Frame.MoveRight != 0.f ? GH_REPLAYFIELD_MoveRight : 0;
+		Fields |= Frame.Turn != 0.f ? GH_REPLAYFIELD_Turn : 0;
+		Fields |= Frame.LookUp != 0.f ? GH_REPLAYFIELD_LookUp : 0;
+		Fields |= Frame.Buttons != 0 ? GH_REPLAYFIELD_Buttons : 0;
+		Fields |= Frame.bSwinging ? GH_REPLAYFIELD_Swing : 0;
+		Fields |= Frame.Reel != 0.f ? GH_REPLAYFIELD_Reel : 0;
+	}
+
+	Ar << Fields;
+	Ar << Frame.DeltaSeconds;
+
+	if (Fields & GH_REPLAYFIELD_MoveForward)
+	{
+		Ar << Frame.MoveForward;
+	}
+	if (Fields & GH_REPLAYFIELD_MoveRight)
+	{
+		Ar << Frame.MoveRight;
+	}
+	if (Fields & GH_REPLAYFIELD_Turn)
+	{
+		Ar << Frame.Turn;
+	}
+	if (Fields & GH_REPLAYFIELD_LookUp)
+	{
+		Ar << Frame.LookUp;
+	}
+	if (Fields & GH_REPLAYFIELD_Buttons)
+	{
+		Ar << Frame.Buttons;
+	}
+	if (Fields & GH_REPLAYFIELD_Reel)
+	{
+		Ar << Frame.Reel;
+	}
+
+	Frame.bSwinging = (Fields & GH_REPLAYFIELD_Swing) != 0;
+	if (Frame.bSwinging)
+	{
+		Ar << Frame.Swing.RopeLength;
+		Ar << Frame.Swing.Angle;
+		Ar << Frame.Swing.AngleVelocity;
+	}
+
+	return Ar;
+}
+
+static FAutoConsoleCommandWithWorldAndArgs ReplayRecordCommand(
+	TEXT("gh.Replay.Record"),
+	TEXT("Records the inputs of the local character to the given file (in Saved/Replays)."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (AGH_ReplayRecorder* Recorder = AGH_ReplayRecorder::Get(World))
+		{
+			Recorder->StartRecording(Args.Num() > 0 ? Args[0] : TEXT("Session"));
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld ReplayStopCommand(
+	TEXT("gh.Replay.Stop"),
+	TEXT("Stops the current replay recording or playback."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (AGH_ReplayRecorder* Recorder = AGH_ReplayRecorder::Get(World))
+		{
+			Recorder->StopRecording();
+			Recorder->StopPlayback();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs ReplayPlayCommand(
+	TEXT("gh.Replay.Play"),
+	TEXT("Replays a recorded session on the local character."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (AGH_ReplayRecorder* Recorder = AGH_ReplayRecorder::Get(World))
+		{
+			Recorder->StartPlayback(Args.Num() > 0 ? Args[0] : TEXT("Session"));
+		}
+	}));
+
+/** Replays are kept in Saved/Replays unless given a full path */
+static FString GetReplayPath(const FString& FileName)
+{
+	const FString WithExtension = FPaths::GetExtension(FileName).IsEmpty() ? FileName + TEXT(".ghreplay") : FileName;
+	return FPaths::IsRelative(WithExtension) ? FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Replays"), WithExtension) : WithExtension;
+}
+
+// Sets default values
+AGH_ReplayRecorder::AGH_ReplayRecorder()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+	// Feeds the inputs before the character moves, see StartPlayback
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+}
+
+AGH_ReplayRecorder* AGH_ReplayRecorder::Get(UWorld* World)
+{
+	if (World == nullptr)
+	{
+		return nullptr;
+	}
+
+	for (TActorIterator<AGH_ReplayRecorder> It(World); It; ++It)
+	{
+		return *It;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.ObjectFlags |= RF_Transient;
+	return World->SpawnActor<AGH_ReplayRecorder>(SpawnParams);
+}
+
+void AGH_ReplayRecorder::RegisterCharacter(AGH_Character* InCharacter)
+{
+	Character = InCharacter;
+
+	// Characters restarted later keep the session going
+	if (bCommandLineHandled)
+	{
+		return;
+	}
+	bCommandLineHandled = true;
+
+	FString CommandLineFile;
+	if (FParse::Value(FCommandLine::Get(), TEXT("GHReplay="), CommandLineFile))
+	{
+		bExitAfterPlayback = StartPlayback(CommandLineFile);
+	}
+	else if (FParse::Value(FCommandLine::Get(), TEXT("GHRecord="), CommandLineFile))
+	{
+		StartRecording(CommandLineFile);
+	}
+}
+
+bool AGH_ReplayRecorder::StartRecording(const FString& InFileName)
+{
+	if (bRecording || bPlaying || !Character.IsValid())
+	{
+		UE_LOG(LogGHReplay, Warning, TEXT("Cannot record, %s"), !Character.IsValid() ? TEXT("no local character") : TEXT("a replay is running"));
+		return false;
+	}
+
+	FileName = GetReplayPath(InFileName);
+	Frames.Reset();
+	RecordFrameNumber = GFrameCounter;
+	StartTransform = Character->GetActorTransform();
+	StartControlRotation = Character->GetControlRotation();
+	bRecording = true;
+
+	UE_LOG(LogGHReplay, Log, TEXT("Recording to %s"), *FileName);
+	return true;
+}
+
+void AGH_ReplayRecorder::StopRecording()
+{
+	if (!bRecording)
+	{
+		return;
+	}
+
+	FinishRecordFrame();
+	bRecording = false;
+
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+
+	uint32 Magic = GHReplayMagic;
+	uint32 Version = GHReplayVersion;
+	FString MapName = GetWorld()->GetMapName();
+	int32 NumFrames = Frames.Num();
+	Writer << Magic << Version << MapName << StartTransform << StartControlRotation << NumFrames;
+	for (FGH_ReplayFrame& Frame : Frames)
+	{
+		Writer << Frame;
+	}
+
+	if (FFileHelper::SaveArrayToFile(Data, *FileName))
+	{
+		UE_LOG(LogGHReplay, Log, TEXT("Recorded %d frames in %s (%d bytes)"), NumFrames, *FileName, Data.Num());
+	}
+	else
+	{
+		UE_LOG(LogGHReplay, Error, TEXT("Failed to write %s"), *FileName);
+	}
+	Frames.Empty();
+}
+
+bool AGH_ReplayRecorder::StartPlayback(const FString& InFileName)
+{
+	if (bRecording || bPlaying || !Character.IsValid())
+	{
+		UE_LOG(LogGHReplay, Warning, TEXT("Cannot play, %s"), !Character.IsValid() ? TEXT("no local character") : TEXT("a replay is running"));
+		return false;
+	}
+
+	FileName = GetReplayPath(InFileName);
+
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *FileName))
+	{
+		UE_LOG(LogGHReplay, Error, TEXT("Failed to read %s"), *FileName);
+		return false;
+	}
+
+	FMemoryReader Reader(Data);
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	FString MapName;
+	int32 NumFrames = 0;
+	Reader << Magic << Version;
+	if (Magic != GHReplayMagic || Version != GHReplayVersion)
+	{
+		UE_LOG(LogGHReplay, Error, TEXT("%s is not a replay of this version"), *FileName);
+		return false;
+	}
+
+	Reader << MapName << StartTransform << StartControlRotation << NumFrames;
+	if (MapName != GetWorld()->GetMapName())
+	{
+		UE_LOG(LogGHReplay, Warning, TEXT("%s was recorded on %s"), *FileName, *MapName);
+	}
+
+	// A frame holds at least its field mask and its delta time, a corrupted count cannot allocate more than the file holds
+	const int64 MinFrameSize = sizeof(uint8) + sizeof(float);
+	if (NumFrames < 0 || NumFrames > (Reader.TotalSize() - Reader.Tell()) / MinFrameSize)
+	{
+		UE_LOG(LogGHReplay, Error, TEXT("%s is corrupted, %d frames do not fit in the file"), *FileName, NumFrames);
+		return false;
+	}
+
+	Frames.SetNum(NumFrames);
+	for (FGH_ReplayFrame& Frame : Frames)
+	{
+		Reader << Frame;
+	}
+	if (Reader.IsError() || Frames.Num() == 0)
+	{
+		UE_LOG(LogGHReplay, Error, TEXT("%s is corrupted"), *FileName);
+		Frames.Empty();
+		return false;
+	}
+
+	// The recorded inputs replace the player ones
+	Character->TeleportTo(StartTransform.GetLocation(), StartTransform.Rotator());
+	if (APlayerController* PlayerController = Cast<APlayerController>(Character->GetController()))
+	{
+		PlayerController->SetControlRotation(StartControlRotation);
+		Character->DisableInput(PlayerController);
+		// The controller applies the recorded rotation inputs after the recorder gave them
+		PlayerController->AddTickPrerequisiteActor(this);
+	}
+	Character->GetCharacterMovement()->AddTickPrerequisiteActor(this);
+
+	// Frames run back to back with the recorded times
+	bPreviousUseFixedTimeStep = FApp::UseFixedTimeStep();
+	PreviousFixedDeltaTime = FApp::GetFixedDeltaTime();
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(Frames[0].DeltaSeconds);
+
+	bPlaying = true;
+	PlaybackFrame = 0;
+	PlaybackStartTime = FPlatformTime::Seconds();
+	PlaybackSimulatedTime = 0.f;
+	FirstDivergentFrame = INDEX_NONE;
+	SetActorTickEnabled(true);
+
+	UE_LOG(LogGHReplay, Log, TEXT("Playing %d frames from %s"), Frames.Num(), *FileName);
+	return true;
+}
+
+void AGH_ReplayRecorder::StopPlayback()
+{
+	if (!bPlaying)
+	{
+		return;
+	}
+
+	bPlaying = false;
+	SetActorTickEnabled(false);
+	FApp::SetUseFixedTimeStep(bPreviousUseFixedTimeStep);
+	FApp::SetFixedDeltaTime(PreviousFixedDeltaTime);
+
+	if (Character.IsValid())
+	{
+		Character->GetCharacterMovement()->RemoveTickPrerequisiteActor(this);
+		if (APlayerController* PlayerController = Cast<APlayerController>(Character->GetController()))
+		{
+			PlayerController->RemoveTickPrerequisiteActor(this);
+			Character->EnableInput(PlayerController);
+		}
+	}
+
+	const double WallTime = FPlatformTime::Seconds() - PlaybackStartTime;
+	UE_LOG(LogGHReplay, Log, TEXT("Played %d frames, %.2f s simulated in %.2f s (x%.1f)"), PlaybackFrame, PlaybackSimulatedTime, WallTime, WallTime > 0.0 ? PlaybackSimulatedTime / WallTime : 0.0);
+	if (FirstDivergentFrame != INDEX_NONE)
+	{
+		UE_LOG(LogGHReplay, Warning, TEXT("Swing diverged from the recording at frame %d"), FirstDivergentFrame);
+	}
+
+	Frames.Empty();
+
+	if (bExitAfterPlayback)
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+FGH_ReplayFrame& AGH_ReplayRecorder::GetRecordFrame()
+{
+	if (Frames.Num() == 0 || RecordFrameNumber != GFrameCounter)
+	{
+		FinishRecordFrame();
+		RecordFrameNumber = GFrameCounter;
+
+		FGH_ReplayFrame& Frame = Frames[Frames.AddDefaulted()];
+		Frame.DeltaSeconds = FApp::GetDeltaTime();
+	}
+
+	return Frames.Last();
+}
+
+void AGH_ReplayRecorder::FinishRecordFrame()
+{
+	FGH_PendulumState State;
+	if (Frames.Num() > 0 && Character.IsValid() && Character->GetSwingState(State))
+	{
+		Frames.Last().bSwinging = true;
+		Frames.Last().Swing = FGH_QuantizedSwing::FromState(State);
+	}
+}
+
+void AGH_ReplayRecorder::RecordAxis(float FGH_ReplayFrame::* Axis, float Value)
+{
+	if (bRecording)
+	{
+		GetRecordFrame().*Axis += Value;
+	}
+}
+
+void AGH_ReplayRecorder::RecordButton(EGH_ReplayButton Button)
+{
+	if (bRecording)
+	{
+		GetRecordFrame().Buttons |= Button;
+	}
+}
+
+void AGH_ReplayRecorder::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (!bPlaying)
+	{
+		return;
+	}
+
+	if (!Character.IsValid() || PlaybackFrame >= Frames.Num())
+	{
+		StopPlayback();
+		return;
+	}
+
+	// The swing recorded at the end of the previous frame
+	FGH_PendulumState State;
+	if (PlaybackFrame > 0 && FirstDivergentFrame == INDEX_NONE)
+	{
+		const FGH_ReplayFrame& Previous = Frames[PlaybackFrame - 1];
+		const bool bSwinging = Character->GetSwingState(State);
+		if (bSwinging != Previous.bSwinging || (bSwinging && FMath::Abs((int16)(FGH_QuantizedSwing::FromState(State).Angle - Previous.Swing.Angle)) > 16))
+		{
+			FirstDivergentFrame = PlaybackFrame - 1;
+		}
+	}
+
+	const FGH_ReplayFrame& Frame = Frames[PlaybackFrame];
+	Character->ApplyReplayFrame(Frame);
+	PlaybackSimulatedTime += Frame.DeltaSeconds;
+
+	++PlaybackFrame;
+	if (Frames.IsValidIndex(PlaybackFrame))
+	{
+		FApp::SetFixedDeltaTime(Frames[PlaybackFrame].DeltaSeconds);
+	}
+}
+
+void AGH_ReplayRecorder::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	StopRecording();
+	StopPlayback();
+
+	Super::EndPlay(EndPlayReason);
+}
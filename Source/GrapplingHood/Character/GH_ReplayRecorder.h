@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "GH_SwingReplication.h"
+#include "GH_ReplayRecorder.generated.h"
+
+class AGH_Character;
+
+/** Buttons pressed or released during a replay frame */
+enum EGH_ReplayButton : uint8
+{
+	GH_REPLAY_Fire = 1 << 0,
+	GH_REPLAY_JumpPressed = 1 << 1,
+	GH_REPLAY_JumpReleased = 1 << 2,
+	GH_REPLAY_FireSecondary = 1 << 3
+};
+
+/** Inputs of the recorded character during one frame, and its swing state at the end of the frame */
+struct FGH_ReplayFrame
+{
+	/** Engine frame time, played back as a fixed time step */
+	float DeltaSeconds = 0.f;
+
+	float MoveForward = 0.f;
+	float MoveRight = 0.f;
+	/** Yaw and pitch input added to the controller */
+	float Turn = 0.f;
+	float LookUp = 0.f;
+	/** Rope reel input, positive to reel in */
+	float Reel = 0.f;
+
+	/** EGH_ReplayButton flags */
+	uint8 Buttons = 0;
+
+	/** Swing state, compared on playback to find where the simulation diverges */
+	bool bSwinging = false;
+	FGH_QuantizedSwing Swing;
+
+	/** Writes only the fields used by the frame, behind a mask byte */
+	friend FArchive& operator<<(FArchive& Ar, FGH_ReplayFrame& Frame);
+};
+
+/**
+ * World-level recorder of the inputs of the local character, and player of the recorded sessions.
+ * Playback feeds the recorded inputs with the recorded frame times as fixed time steps, so a session replays
+ * the same hook and swing workload, faster than real time on a -nullrhi -benchmark run.
+ * Recording and playback start with gh.Replay.Record / gh.Replay.Play, or from the command line with -GHRecord= / -GHReplay=.
+ */
+UCLASS(notplaceable)
+class GRAPPLINGHOOD_API AGH_ReplayRecorder : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	AGH_ReplayRecorder();
+
+	/** Returns the replay recorder of the world, spawning it on first use */
+	static AGH_ReplayRecorder* Get(UWorld* World);
+
+	/** Called by the locally controlled character when it starts playing, starts the command line recording or playback */
+	void RegisterCharacter(AGH_Character* Character);
+
+	/** Starts recording the inputs of the registered character */
+	bool StartRecording(const FString& InFileName);
+
+	/** Writes the recorded session to its file */
+	void StopRecording();
+
+	/** Loads a session and replays it on the registered character */
+	bool StartPlayback(const FString& InFileName);
+
+	/** Ends the playback and logs its timings */
+	void StopPlayback();
+
+	FORCEINLINE bool IsRecording() const { return bRecording; }
+	FORCEINLINE bool IsPlaying() const { return bPlaying; }
+
+	// Inputs of the recorded character, accumulated over the current frame
+	void RecordAxis(float FGH_ReplayFrame::* Axis, float Value);
+	void RecordButton(EGH_ReplayButton Button);
+
+	virtual void Tick(float DeltaSeconds) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+protected:
+	/** Starts a new frame when the engine moved to the next one */
+	FGH_ReplayFrame& GetRecordFrame();
+
+	/** Adds the swing state to the last recorded frame */
+	void FinishRecordFrame();
+
+	TWeakObjectPtr<AGH_Character> Character;
+
+	bool bRecording = false;
+	bool bPlaying = false;
+	/** Quit when the playback started from the command line ends */
+	bool bExitAfterPlayback = false;
+	bool bCommandLineHandled = false;
+
+	FString FileName;
+	TArray<FGH_ReplayFrame> Frames;
+
+	/** Engine frame of the last recorded frame */
+	uint64 RecordFrameNumber = 0;
+
+	/** Character start, restored before playing */
+	FTransform StartTransform;
+	FRotator StartControlRotation;
+
+	// Playback progress
+	int32 PlaybackFrame = 0;
+	double PlaybackStartTime = 0.0;
+	float PlaybackSimulatedTime = 0.f;
+	int32 FirstDivergentFrame = INDEX_NONE;
+
+	/** Engine fixed time step settings before the playback */
+	bool bPreviousUseFixedTimeStep = false;
+	double PreviousFixedDeltaTime = 0.0;
+};
@@ -0,0 +1,167 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GH_RopeComponent.h"
+#include "GH_RopeRenderer.h"
+#include "Engine/World.h"
+
+namespace
+{
+	/** Maximum simulation steps run in one frame */
+	const int32 MaxRopeStepsPerFrame = 4;
+
+	FORCEINLINE FGH_SwingVector ToSwingVector(const FVector& Vector) { return FGH_SwingVector(Vector.X, Vector.Y, Vector.Z); }
+}
+
+// Sets default values for this component's properties
+UGH_RopeComponent::UGH_RopeComponent()
+{
+	// The renderer updates the ropes, nothing to do per component
+	PrimaryComponentTick.bCanEverTick = false;
+
+	Points.SetNum(2);
+}
+
+void UGH_RopeComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	Renderer = AGH_RopeRenderer::Get(GetWorld());
+}
+
+void UGH_RopeComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (Renderer != nullptr)
+	{
+		Renderer->UnregisterRope(this);
+		Renderer = nullptr;
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UGH_RopeComponent::SetEndpoints(const FVector& Start, const FVector& End, EGH_RopeLength LengthMode)
+{
+	RopeStart = Start;
+	RopeEnd = End;
+
+	switch (LengthMode)
+	{
+	case EGH_RopeLength::PayOut:
+		RestLength = FVector::Dist(Start, End) * (1.f + Slack);
+		break;
+	case EGH_RopeLength::Taut:
+		RestLength = FVector::Dist(Start, End);
+		break;
+	default:
+		break;
+	}
+
+	if (bRopeVisible)
+	{
+		MarkRopeDirty();
+	}
+}
+
+void UGH_RopeComponent::SetBends(const FVector* InBends, int32 NumBends)
+{
+	Bends.SetNum(NumBends, false);
+	for (int32 Bend = 0; Bend < NumBends; ++Bend)
+	{
+		Bends[Bend] = InBends[Bend];
+	}
+
+	if (bRopeVisible)
+	{
+		MarkRopeDirty();
+	}
+}
+
+void UGH_RopeComponent::SetRopeVisibility(bool bNewVisibility)
+{
+	if (bRopeVisible != bNewVisibility)
+	{
+		bRopeVisible = bNewVisibility;
+		MarkRopeDirty();
+	}
+}
+
+void UGH_RopeComponent::MarkRopeDirty()
+{
+	if (!bRopeDirty && Renderer != nullptr)
+	{
+		bRopeDirty = true;
+		Renderer->MarkRopeDirty(this);
+	}
+}
+
+void UGH_RopeComponent::UpdatePoints(float DeltaSeconds, const TArray<FVector>& ViewLocations)
+{
+	// Resolution from the closest view, a rope seen by nobody (e.g. on a server) stays straight
+	int32 NumSegments = 1;
+	int32 NumIterations = 1;
+	if (bSimulateSegments && ViewLocations.Num() > 0)
+	{
+		const FVector Center = (RopeStart + RopeEnd) / 2;
+		float ViewDistanceSquared = MAX_flt;
+		for (const FVector& ViewLocation : ViewLocations)
+		{
+			ViewDistanceSquared = FMath::Min(ViewDistanceSquared, FVector::DistSquared(Center, ViewLocation));
+		}
+
+		const float Alpha = FMath::Clamp((FMath::Sqrt(ViewDistanceSquared) - LODNearDistance) / FMath::Max(LODFarDistance - LODNearDistance, 1.f), 0.f, 1.f);
+		// The segment count only changes once the view moved well past the switch distance, each resample costs a step of accuracy
+		const float TargetSegments = FMath::Lerp((float)MaxSegments, 1.f, Alpha);
+		const bool bKeepSegments = bSimulationActive && FMath::Abs(TargetSegments - Simulation.GetNumSegments()) < 0.5f + LODSegmentHysteresis;
+		NumSegments = bKeepSegments ? Simulation.GetNumSegments() : FMath::RoundToInt(TargetSegments);
+		NumIterations = FMath::Max(FMath::RoundToInt(FMath::Lerp((float)MaxIterations, 1.f, Alpha)), 1);
+	}
+
+	// A rope bent around the geometry is taut, drawn straight from bend to bend
+	if (NumSegments <= 1 || Bends.Num() > 0)
+	{
+		bSimulationActive = false;
+		Points.SetNum(Bends.Num() + 2, false);
+		Points[0] = RopeStart;
+		for (int32 Bend = 0; Bend < Bends.Num(); ++Bend)
+		{
+			Points[Bend + 1] = Bends[Bends.Num() - 1 - Bend];
+		}
+		Points.Last() = RopeEnd;
+		return;
+	}
+
+	if (!bSimulationActive)
+	{
+		Simulation.Reset(NumSegments, ToSwingVector(RopeStart), ToSwingVector(RopeEnd));
+		SimulationAccumulator = 0.f;
+		bSimulationActive = true;
+	}
+	else
+	{
+		Simulation.Resample(NumSegments);
+	}
+	Simulation.SetRestLength(RestLength);
+
+	FGH_VerletRopeSettings Settings;
+	Settings.Gravity = -GetWorld()->GetGravityZ();
+	Settings.Damping = Damping;
+	Settings.Iterations = NumIterations;
+
+	SimulationAccumulator = FMath::Min(SimulationAccumulator + DeltaSeconds, SimulationTimeStep * MaxRopeStepsPerFrame);
+	while (SimulationAccumulator >= SimulationTimeStep)
+	{
+		Simulation.Step(Settings, SimulationTimeStep, ToSwingVector(RopeStart), ToSwingVector(RopeEnd));
+		SimulationAccumulator -= SimulationTimeStep;
+	}
+
+	const FGH_SwingVector* SimulatedPoints = Simulation.GetPoints();
+	Points.SetNum(Simulation.GetNumPoints(), false);
+	for (int32 Point = 0; Point < Points.Num(); ++Point)
+	{
+		Points[Point] = FVector(SimulatedPoints[Point].X, SimulatedPoints[Point].Y, SimulatedPoints[Point].Z);
+	}
+
+	// The ends follow the owner every frame, the steps may not have run this frame
+	Points[0] = RopeStart;
+	Points.Last() = RopeEnd;
+}
@@ -0,0 +1,130 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Algorithm/GH_VerletRope.h"
+#include "GH_RopeComponent.generated.h"
+
+class AGH_RopeRenderer;
+
+/** How the rest length of the rope follows its ends */
+enum class EGH_RopeLength : uint8
+{
+	/** Rope pays out or reels in, a bit longer than the ends distance */
+	PayOut,
+	/** Rope keeps its length, going slack when the ends get closer */
+	Fixed,
+	/** Rope is stretched exactly between its ends */
+	Taut
+};
+
+/**
+ * Rope visual of a character, a polyline drawn by the world rope renderer.
+ * Setting the ends is cheap, the renderer updates the points and pushes the instance transforms once per frame.
+ * The rope is either a straight segment or a sagging Verlet rope whose resolution depends on the camera distance.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class GRAPPLINGHOOD_API UGH_RopeComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	UGH_RopeComponent();
+
+	/** Rope thickness (in cm) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Rope)
+	float Radius = 2.f;
+
+	/** Simulates the rope as segments able to sag and go slack instead of a straight line */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Rope)
+	bool bSimulateSegments = false;
+
+	/** Segment count of a rope close to the camera */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Rope, meta = (ClampMin = "1", EditCondition = "bSimulateSegments"))
+	int32 MaxSegments = 16;
+
+	/** Constraint passes per step of a rope close to the camera */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Rope, meta = (ClampMin = "1", EditCondition = "bSimulateSegments"))
+	int32 MaxIterations = 8;
+
+	/** Camera distance under which the rope uses the full resolution (in cm) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Rope, meta = (EditCondition = "bSimulateSegments"))
+	float LODNearDistance = 1000.f;
+
+	/** Camera distance from which the rope is drawn straight and not simulated (in cm) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Rope, meta = (EditCondition = "bSimulateSegments"))
+	float LODFarDistance = 6000.f;
+
+	/** Segments the camera distance must move the segment count by before the rope is resampled, keeps small camera moves from resampling */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Rope, meta = (ClampMin = "0", EditCondition = "bSimulateSegments"))
+	float LODSegmentHysteresis = 0.5f;
+
+	/** Extra length of a paying out rope, as a fraction of the ends distance */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Rope, meta = (ClampMin = "0", EditCondition = "bSimulateSegments"))
+	float Slack = 0.05f;
+
+	/** Fraction of the particle velocity lost at each step */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Rope, meta = (ClampMin = "0", ClampMax = "1", EditCondition = "bSimulateSegments"))
+	float Damping = 0.02f;
+
+	/** Duration of one rope simulation step (in s) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Rope, meta = (ClampMin = "0.001", EditCondition = "bSimulateSegments"))
+	float SimulationTimeStep = 1.f / 60.f;
+
+	/** Moves the ends of the rope to two world locations */
+	void SetEndpoints(const FVector& Start, const FVector& End, EGH_RopeLength LengthMode = EGH_RopeLength::PayOut);
+
+	/** Sets the points the rope bends around, from the end to the start. A bent rope is drawn straight through them */
+	void SetBends(const FVector* InBends, int32 NumBends);
+
+	/** Shows or hides the rope */
+	void SetRopeVisibility(bool bNewVisibility);
+
+	/** Returns whether the rope is drawn **/
+	FORCEINLINE bool IsRopeVisible() const { return bRopeVisible; }
+	/** Returns the world locations the rope goes through **/
+	FORCEINLINE const TArray<FVector>& GetPoints() const { return Points; }
+
+protected:
+	// Called when the game starts
+	virtual void BeginPlay() override;
+
+	// Called when the component is removed from the world
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Queues the rope for the next renderer update */
+	void MarkRopeDirty();
+
+	/** Rebuilds the points from the ends, simulating the segments at the resolution matching the closest view */
+	void UpdatePoints(float DeltaSeconds, const TArray<FVector>& ViewLocations);
+
+	/** World renderer batching every rope */
+	UPROPERTY(Transient)
+	AGH_RopeRenderer* Renderer = nullptr;
+
+	/** World locations the rope goes through */
+	TArray<FVector> Points;
+
+	FVector RopeStart = FVector::ZeroVector;
+	FVector RopeEnd = FVector::ZeroVector;
+	float RestLength = 0.f;
+
+	/** Points the rope bends around, from the end */
+	TArray<FVector> Bends;
+
+	/** Particles of the segmented rope, empty while drawn straight */
+	FGH_VerletRope Simulation;
+	bool bSimulationActive = false;
+	float SimulationAccumulator = 0.f;
+
+	/** Renderer instances drawing each segment between two points */
+	TArray<int32> SegmentInstances;
+
+	bool bRopeVisible = false;
+	bool bRopeDirty = false;
+
+	friend class AGH_RopeRenderer;
+};
@@ -0,0 +1,142 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GH_RopeRenderer.h"
+#include "GH_RopeComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "UObject/ConstructorHelpers.h"
+
+namespace
+{
+	/** Transform of an instance that is not drawn */
+	const FTransform HiddenSegmentTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector);
+}
+
+// Sets default values
+AGH_RopeRenderer::AGH_RopeRenderer()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = true;
+	// Flush once every character has moved its rope
+	PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+
+	Segments = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("Segments"));
+	Segments->SetStaticMesh(ConstructorHelpers::FObjectFinder<UStaticMesh>(TEXT("/Engine/BasicShapes/Cylinder")).Object);
+	Segments->SetMobility(EComponentMobility::Movable);
+	Segments->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Segments->SetCanEverAffectNavigation(false);
+	RootComponent = Segments;
+}
+
+AGH_RopeRenderer* AGH_RopeRenderer::Get(UWorld* World)
+{
+	if (World == nullptr)
+	{
+		return nullptr;
+	}
+
+	for (TActorIterator<AGH_RopeRenderer> It(World); It; ++It)
+	{
+		return *It;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.ObjectFlags |= RF_Transient;
+	return World->SpawnActor<AGH_RopeRenderer>(SpawnParams);
+}
+
+void AGH_RopeRenderer::MarkRopeDirty(UGH_RopeComponent* Rope)
+{
+	DirtyRopes.Add(Rope);
+}
+
+void AGH_RopeRenderer::UnregisterRope(UGH_RopeComponent* Rope)
+{
+	DirtyRopes.RemoveSwap(Rope);
+	Rope->bRopeDirty = false;
+
+	for (int32 SegmentIndex : Rope->SegmentInstances)
+	{
+		ReleaseSegment(SegmentIndex);
+	}
+	Rope->SegmentInstances.Reset();
+}
+
+void AGH_RopeRenderer::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	// Views of the local players, used to pick the resolution of the simulated ropes
+	TArray<FVector> ViewLocations;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		if (PlayerController != nullptr && PlayerController->IsLocalController() && PlayerController->PlayerCameraManager != nullptr)
+		{
+			ViewLocations.Add(PlayerController->PlayerCameraManager->GetCameraLocation());
+		}
+	}
+
+	for (UGH_RopeComponent* Rope : DirtyRopes)
+	{
+		Rope->bRopeDirty = false;
+
+		if (Rope->IsRopeVisible())
+		{
+			Rope->UpdatePoints(DeltaSeconds, ViewLocations);
+		}
+
+		const int32 NumSegments = Rope->IsRopeVisible() ? FMath::Max(Rope->Points.Num() - 1, 0) : 0;
+
+		// Match the instance count to the segment count
+		while (Rope->SegmentInstances.Num() > NumSegments)
+		{
+			ReleaseSegment(Rope->SegmentInstances.Pop(false));
+		}
+		while (Rope->SegmentInstances.Num() < NumSegments)
+		{
+			Rope->SegmentInstances.Add(AllocateSegment());
+		}
+
+		// The cylinder mesh is 100 units wide and high, centered on its origin
+		const float WidthScale = Rope->Radius / 50.f;
+		for (int32 Segment = 0; Segment < NumSegments; ++Segment)
+		{
+			const FVector& Start = Rope->Points[Segment];
+			const FVector StartToEnd = Rope->Points[Segment + 1] - Start;
+			const FTransform SegmentTransform(FRotationMatrix::MakeFromZ(StartToEnd).ToQuat(), Start + StartToEnd / 2, FVector(WidthScale, WidthScale, StartToEnd.Size() / 100.f));
+
+			Segments->UpdateInstanceTransform(Rope->SegmentInstances[Segment], SegmentTransform, true, false, true);
+		}
+
+		bSegmentsDirty = true;
+	}
+	DirtyRopes.Reset();
+
+	if (bSegmentsDirty)
+	{
+		Segments->MarkRenderStateDirty();
+		bSegmentsDirty = false;
+	}
+}
+
+int32 AGH_RopeRenderer::AllocateSegment()
+{
+	if (FreeSegments.Num() > 0)
+	{
+		return FreeSegments.Pop(false);
+	}
+
+	return Segments->AddInstanceWorldSpace(HiddenSegmentTransform);
+}
+
+void AGH_RopeRenderer::ReleaseSegment(int32 SegmentIndex)
+{
+	// Instances are never removed so the indices held by the ropes stay valid
+	Segments->UpdateInstanceTransform(SegmentIndex, HiddenSegmentTransform, true, false, true);
+	FreeSegments.Add(SegmentIndex);
+	bSegmentsDirty = true;
+}
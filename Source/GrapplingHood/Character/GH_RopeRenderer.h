@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "GH_RopeRenderer.generated.h"
+
+class UGH_RopeComponent;
+class UInstancedStaticMeshComponent;
+
+/**
+ * World-level renderer drawing the segments of every rope as instances of a single mesh.
+ * Ropes changed during the frame are flushed together, with one render state update.
+ */
+UCLASS(notplaceable)
+class GRAPPLINGHOOD_API AGH_RopeRenderer : public AActor
+{
+	GENERATED_BODY()
+
+	/** One instance per rope segment, a cylinder stretched between two rope points */
+	UPROPERTY(VisibleAnywhere, Category = Rope)
+	UInstancedStaticMeshComponent* Segments;
+
+public:
+	// Sets default values for this actor's properties
+	AGH_RopeRenderer();
+
+	/** Returns the rope renderer of the world, spawning it on first use */
+	static AGH_RopeRenderer* Get(UWorld* World);
+
+	/** Queues a rope whose points or visibility changed */
+	void MarkRopeDirty(UGH_RopeComponent* Rope);
+
+	/** Frees the instances of a rope */
+	void UnregisterRope(UGH_RopeComponent* Rope);
+
+	virtual void Tick(float DeltaSeconds) override;
+
+protected:
+	/** Returns an unused instance index */
+	int32 AllocateSegment();
+
+	/** Hides an instance and makes it available again */
+	void ReleaseSegment(int32 SegmentIndex);
+
+	/** Ropes to update at the end of the frame */
+	UPROPERTY(Transient)
+	TArray<UGH_RopeComponent*> DirtyRopes;
+
+	/** Hidden instances available for new segments */
+	TArray<int32> FreeSegments;
+
+	/** Whether instances changed since the last render state update */
+	bool bSegmentsDirty = false;
+};
@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GH_SavedMove.h"
+#include "GH_Character.h"
+#include "GH_CharacterMovementComponent.h"
+
+void FGH_SavedMove::Clear()
+{
+	Super::Clear();
+
+	bSwinging = false;
+	Swing = FGH_QuantizedSwing();
+	SwingStart = FGH_FixedStepPendulum();
+	SwingMoveId = 0;
+}
+
+void FGH_SavedMove::SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, class FNetworkPredictionData_Client_Character& ClientData)
+{
+	Super::SetMoveFor(C, InDeltaTime, NewAccel, ClientData);
+
+	UGH_CharacterMovementComponent* Movement = Cast<UGH_CharacterMovementComponent>(C->GetCharacterMovement());
+	const AGH_Character* Character = Cast<AGH_Character>(C);
+
+	// The rope of the owning client is stepped by its moves, the state has not moved yet this move
+	if (Movement != nullptr && Character != nullptr && Movement->IsSwinging() && Character->GetSwingMove(SwingStart))
+	{
+		bSwinging = true;
+		Swing = FGH_QuantizedSwing::FromState(SwingStart.State, Character->GetNumRopeWraps());
+		SwingMoveId = Movement->AllocateSwingMoveId();
+	}
+}
+
+bool FGH_SavedMove::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const
+{
+	const FGH_SavedMove* NewSwingMove = static_cast<const FGH_SavedMove*>(NewMove.Get());
+
+	// The swing runs in fixed steps, the combined move runs the steps of both moves from the first state (see CombineWith).
+	// Only the moves around the same wrap points and reeling alike are the same swing
+	if (bSwinging != NewSwingMove->bSwinging)
+	{
+		return false;
+	}
+
+	if (bSwinging && (Swing.NumWraps != NewSwingMove->Swing.NumWraps || SwingStart.State.ReelSpeed != NewSwingMove->SwingStart.State.ReelSpeed))
+	{
+		return false;
+	}
+
+	return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+void FGH_SavedMove::CombineWith(const FSavedMove_Character* OldMove, ACharacter* InCharacter, APlayerController* PC, const FVector& OldStartLocation)
+{
+	Super::CombineWith(OldMove, InCharacter, PC, OldStartLocation);
+
+	// Back to the swing the pending move started from, like the character is moved back to its start location
+	const FGH_SavedMove* OldSwingMove = static_cast<const FGH_SavedMove*>(OldMove);
+	AGH_Character* Character = Cast<AGH_Character>(InCharacter);
+	if (bSwinging && Character != nullptr)
+	{
+		Swing = OldSwingMove->Swing;
+		SwingStart = OldSwingMove->SwingStart;
+		Character->CommitSwingMove(SwingStart);
+	}
+}
+
+void FGH_SavedMove::PrepMoveFor(ACharacter* C)
+{
+	Super::PrepMoveFor(C);
+
+	// Replays start from the swing the move was first done with
+	UGH_CharacterMovementComponent* Movement = Cast<UGH_CharacterMovementComponent>(C->GetCharacterMovement());
+	if (bSwinging && Movement != nullptr)
+	{
+		Movement->SetReplaySwing(SwingStart, Swing.NumWraps);
+	}
+}
+
+FGH_NetworkPredictionData_Client::FGH_NetworkPredictionData_Client(const UCharacterMovementComponent& ClientMovement)
+	: Super(ClientMovement)
+{
+}
+
+FSavedMovePtr FGH_NetworkPredictionData_Client::AllocateNewMove()
+{
+	return FSavedMovePtr(new FGH_SavedMove());
+}
@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GH_SwingReplication.h"
+
+/** Client move of a grappling character, remembering the swing state the move started from */
+class GRAPPLINGHOOD_API FGH_SavedMove : public FSavedMove_Character
+{
+public:
+	typedef FSavedMove_Character Super;
+
+	/** Whether the move was done hanging from the rope */
+	bool bSwinging = false;
+
+	/** Swing state at the start of the move, as sent to the server */
+	FGH_QuantizedSwing Swing;
+
+	/** Fixed step solver at the start of the move, replays start from it */
+	FGH_FixedStepPendulum SwingStart;
+
+	/** Id of the move, sent with the swing data */
+	uint8 SwingMoveId = 0;
+
+	virtual void Clear() override;
+	virtual void SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, class FNetworkPredictionData_Client_Character& ClientData) override;
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override;
+	virtual void CombineWith(const FSavedMove_Character* OldMove, ACharacter* InCharacter, APlayerController* PC, const FVector& OldStartLocation) override;
+	virtual void PrepMoveFor(ACharacter* C) override;
+};
+
+/** Client prediction data of a grappling character, allocating FGH_SavedMove */
+class GRAPPLINGHOOD_API FGH_NetworkPredictionData_Client : public FNetworkPredictionData_Client_Character
+{
+public:
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	FGH_NetworkPredictionData_Client(const UCharacterMovementComponent& ClientMovement);
+
+	virtual FSavedMovePtr AllocateNewMove() override;
+};
@@ -0,0 +1,179 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GH_SwingBotController.h"
+#include "GH_Character.h"
+#include "GH_AnchorIndex.h"
+#include "GrapplingHood.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGHBot, Log, All);
+
+DECLARE_CYCLE_STAT(TEXT("Bot tick"), STAT_GH_BotTick, STATGROUP_Grappling);
+
+AGH_SwingBotController::AGH_SwingBotController()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+}
+
+void AGH_SwingBotController::Possess(APawn* InPawn)
+{
+	Super::Possess(InPawn);
+
+	GHCharacter = Cast<AGH_Character>(InPawn);
+	AnchorIndex = AGH_AnchorIndex::Get(GetWorld());
+	RandomStream.Initialize(GetUniqueID());
+
+	if (GHCharacter == nullptr || AnchorIndex == nullptr || AnchorIndex->GetNumSwingLinks() == 0)
+	{
+		UE_LOG(LogGHBot, Warning, TEXT("%s: no grappling character or no swing graph in the level, the bot stays idle"), *GetName());
+		return;
+	}
+
+	Route.Reset();
+	SetBotState(EBotState::Planning);
+	SetActorTickEnabled(true);
+}
+
+void AGH_SwingBotController::UnPossess()
+{
+	Super::UnPossess();
+
+	GHCharacter = nullptr;
+	SetActorTickEnabled(false);
+}
+
+void AGH_SwingBotController::SetBotState(EBotState NewState)
+{
+	BotState = NewState;
+	StateStartTime = GetWorld()->GetTimeSeconds();
+}
+
+bool AGH_SwingBotController::PlanRoute()
+{
+	const FVector Location = GHCharacter->GetActorLocation();
+	const int32 Start = AnchorIndex->FindNearestAnchor(Location, GHCharacter->AnchorAimRange);
+	if (Start == INDEX_NONE)
+	{
+		return false;
+	}
+
+	// A few random picks, the anchors out of range are not worth a search
+	const int32 NumAnchors = AnchorIndex->GetNumAnchors();
+	for (int32 Attempt = 0; Attempt < 8; ++Attempt)
+	{
+		const int32 Goal = RandomStream.RandRange(0, NumAnchors - 1);
+		if (Goal != Start && FVector::DistSquared(AnchorIndex->GetAnchorLocation(Goal), Location) <= GoalRange * GoalRange && AnchorIndex->FindSwingPath(Start, Goal, Route))
+		{
+			RouteIndex = 0;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void AGH_SwingBotController::FireAtAnchor(int32 Anchor)
+{
+	const FVector Direction = (AnchorIndex->GetAnchorLocation(Anchor) - GHCharacter->GetMuzzleWorldLocation()).GetSafeNormal();
+	SetControlRotation(Direction.Rotation());
+
+	if (GHCharacter->FireHookTowards(Direction))
+	{
+		SetBotState(EBotState::Firing);
+	}
+}
+
+bool AGH_SwingBotController::ShouldRelease() const
+{
+	if (!GHCharacter->IsRopeLocked() || RouteIndex + 1 >= Route.Num())
+	{
+		return false;
+	}
+
+	// Let go on the rising side of the swing, moving towards the next anchor and close enough to reach it
+	const FVector ToNext = AnchorIndex->GetAnchorLocation(Route[RouteIndex + 1]) - GHCharacter->GetActorLocation();
+	const FVector Velocity = GHCharacter->GetCharacterMovement()->Velocity;
+	return Velocity.Z > 0.f && (Velocity | ToNext) > 0.f && ToNext.SizeSquared() <= FMath::Square(GHCharacter->AnchorAimRange);
+}
+
+void AGH_SwingBotController::Tick(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_GH_BotTick);
+
+	Super::Tick(DeltaSeconds);
+
+	if (GHCharacter == nullptr || GHCharacter->GetHookInstance() == nullptr)
+	{
+		return;
+	}
+
+	const float Now = GetWorld()->GetTimeSeconds();
+	const float TimeInState = Now - StateStartTime;
+	const AGH_Hook::State HookState = GHCharacter->GetHookInstance()->GetState();
+
+	switch (BotState)
+	{
+	case EBotState::Planning:
+		if (HookState != AGH_Hook::State::DOCKED)
+		{
+			GHCharacter->ReleaseRopeAndHook();
+		}
+		else if (Now >= NextPlanTime)
+		{
+			if (PlanRoute())
+			{
+				FireAtAnchor(Route[RouteIndex]);
+			}
+			else
+			{
+				NextPlanTime = Now + PlanRetryDelay;
+			}
+		}
+		break;
+
+	case EBotState::Firing:
+		if (HookState == AGH_Hook::State::HOOKED)
+		{
+			SetBotState(EBotState::Swinging);
+		}
+		else if (HookState != AGH_Hook::State::FIRING || TimeInState > FireTimeout)
+		{
+			// Missed, plan again from where the character ends up
+			GHCharacter->ReleaseRopeAndHook();
+			SetBotState(EBotState::Planning);
+		}
+		break;
+
+	case EBotState::Swinging:
+		if (HookState != AGH_Hook::State::HOOKED)
+		{
+			SetBotState(EBotState::Planning);
+		}
+		else if (ShouldRelease())
+		{
+			GHCharacter->ReleaseRopeAndHook();
+			++RouteIndex;
+			SetBotState(EBotState::Retracting);
+		}
+		else if (TimeInState > SwingTimeout)
+		{
+			// Goal reached or stuck on this anchor
+			GHCharacter->ReleaseRopeAndHook();
+			SetBotState(EBotState::Planning);
+		}
+		break;
+
+	case EBotState::Retracting:
+		if (HookState == AGH_Hook::State::DOCKED)
+		{
+			FireAtAnchor(Route[RouteIndex]);
+		}
+		else if (TimeInState > FireTimeout)
+		{
+			SetBotState(EBotState::Planning);
+		}
+		break;
+	}
+}
@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIController.h"
+#include "GH_SwingBotController.generated.h"
+
+class AGH_Character;
+class AGH_AnchorIndex;
+
+/**
+ * AI driving an AGH_Character from anchor to anchor with the hook, the way a player would:
+ * plans a route on the swing graph of the level anchor index, fires at the first anchor,
+ * and releases on the rising side of each swing to fire at the next one.
+ * Used as a load generator, the plans share the graph cached by the anchor index so hundreds of bots stay cheap.
+ */
+UCLASS(config = Game)
+class GRAPPLINGHOOD_API AGH_SwingBotController : public AAIController
+{
+	GENERATED_BODY()
+
+public:
+	AGH_SwingBotController();
+
+	/** Farthest goal anchor picked for a route (in cm) */
+	UPROPERTY(EditAnywhere, Config, Category = Bot, meta = (ClampMin = "0"))
+	float GoalRange = 20000.f;
+
+	/** Time the hook may travel before the shot is considered missed (in s) */
+	UPROPERTY(EditAnywhere, Config, Category = Bot, meta = (ClampMin = "0"))
+	float FireTimeout = 1.5f;
+
+	/** Longest swing on one anchor before the bot lets go and plans again (in s) */
+	UPROPERTY(EditAnywhere, Config, Category = Bot, meta = (ClampMin = "0"))
+	float SwingTimeout = 6.f;
+
+	/** Delay before planning again after a failed plan (in s) */
+	UPROPERTY(EditAnywhere, Config, Category = Bot, meta = (ClampMin = "0"))
+	float PlanRetryDelay = 1.f;
+
+	virtual void Possess(APawn* InPawn) override;
+	virtual void UnPossess() override;
+	virtual void Tick(float DeltaSeconds) override;
+
+protected:
+	enum class EBotState : uint8
+	{
+		/** Hook docked, looking for a route */
+		Planning,
+		/** Hook flying towards the current anchor */
+		Firing,
+		/** Hook on the current anchor, waiting for the release point */
+		Swinging,
+		/** Rope released, waiting for the hook to come back to fire at the next anchor */
+		Retracting
+	};
+
+	/** Picks a goal anchor around the character and plans the route to it */
+	bool PlanRoute();
+
+	/** Aims and fires the hook at the anchor of the route */
+	void FireAtAnchor(int32 Anchor);
+
+	/** Whether the swing carries the character towards the next anchor of the route */
+	bool ShouldRelease() const;
+
+	void SetBotState(EBotState NewState);
+
+	UPROPERTY(Transient)
+	AGH_Character* GHCharacter = nullptr;
+
+	UPROPERTY(Transient)
+	AGH_AnchorIndex* AnchorIndex = nullptr;
+
+	/** Anchors of the current route */
+	TArray<int32> Route;
+
+	/** Anchor of the route the hook is fired at or hooked to */
+	int32 RouteIndex = 0;
+
+	EBotState BotState = EBotState::Planning;
+	float StateStartTime = 0.f;
+	float NextPlanTime = 0.f;
+
+	FRandomStream RandomStream;
+};
@@ -0,0 +1,475 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GH_SwingManager.h"
+#include "GH_Character.h"
+#include "Algorithm/GH_PendulumBatch.h"
+#include "GrapplingHood.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "Misc/App.h"
+
+DECLARE_CYCLE_STAT(TEXT("Swing batch"), STAT_GH_SwingBatch, STATGROUP_Grappling);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Locked ropes"), STAT_GH_LockedRopes, STATGROUP_Grappling);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Ropes per ms"), STAT_GH_RopesPerMs, STATGROUP_Grappling);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Swing solve time saved (ms)"), STAT_GH_SwingTimeSaved, STATGROUP_Grappling);
+
+static TAutoConsoleVariable<int32> CVarSwingParallel(
+	TEXT("gh.Swing.Parallel"),
+	1,
+	TEXT("Integrates the locked ropes on the worker threads.\n")
+	TEXT(" 0: serial on the game thread\n")
+	TEXT(" 1: parallel (default)"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarSwingParallelBatchSize(
+	TEXT("gh.Swing.ParallelBatchSize"),
+	64,
+	TEXT("Number of ropes integrated by one worker task."),
+	ECVF_Default);
+
+static_assert(sizeof(FVector) == sizeof(FGH_SwingVector), "The body arrays are stepped by the rope constraints core");
+
+// Sets default values
+AGH_SwingManager::AGH_SwingManager()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+	static_assert((uint8)EGH_SwingIntegrator::RK4 == (uint8)EGH_PendulumIntegrator::RK4, "EGH_SwingIntegrator must mirror EGH_PendulumIntegrator");
+}
+
+AGH_SwingManager* AGH_SwingManager::Get(UWorld* World)
+{
+	if (World == nullptr)
+	{
+		return nullptr;
+	}
+
+	for (TActorIterator<AGH_SwingManager> It(World); It; ++It)
+	{
+		return *It;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.ObjectFlags |= RF_Transient;
+	return World->SpawnActor<AGH_SwingManager>(SpawnParams);
+}
+
+int32 AGH_SwingManager::RegisterRope(AGH_Character* Character, const FGH_PendulumState& State)
+{
+	const int32 RopeIndex = Owners.Add(Character);
+
+	RopeLength.Add(State.RopeLength);
+	Angle.Add(State.Angle);
+	AngleVelocity.Add(State.AngleVelocity);
+	PreviousAngle.Add(State.Angle);
+	ReelSpeed.Add(State.ReelSpeed);
+	SinAngle.Add(FMath::Sin(State.Angle));
+	CosAngle.Add(FMath::Cos(State.Angle));
+	PlaneNormal.Add(FVector(State.PlaneNormal.X, State.PlaneNormal.Y, State.PlaneNormal.Z));
+	RopeMoveDriven.Add(false);
+
+	return RopeIndex;
+}
+
+void AGH_SwingManager::UnregisterRope(int32 RopeIndex)
+{
+	check(Owners.IsValidIndex(RopeIndex));
+
+	NumMoveDrivenRopes -= RopeMoveDriven[RopeIndex] ? 1 : 0;
+
+	Owners.RemoveAtSwap(RopeIndex, 1, false);
+	RopeLength.RemoveAtSwap(RopeIndex, 1, false);
+	Angle.RemoveAtSwap(RopeIndex, 1, false);
+	AngleVelocity.RemoveAtSwap(RopeIndex, 1, false);
+	PreviousAngle.RemoveAtSwap(RopeIndex, 1, false);
+	ReelSpeed.RemoveAtSwap(RopeIndex, 1, false);
+	SinAngle.RemoveAtSwap(RopeIndex, 1, false);
+	CosAngle.RemoveAtSwap(RopeIndex, 1, false);
+	PlaneNormal.RemoveAtSwap(RopeIndex, 1, false);
+	RopeMoveDriven.RemoveAtSwap(RopeIndex, 1, false);
+
+	// The last rope took the freed slot
+	if (Owners.IsValidIndex(RopeIndex))
+	{
+		Owners[RopeIndex]->SetSwingRopeIndex(RopeIndex);
+	}
+}
+
+FGH_PendulumState AGH_SwingManager::GetRopeState(int32 RopeIndex) const
+{
+	FGH_PendulumState State;
+	State.RopeLength = RopeLength[RopeIndex];
+	State.Angle = Angle[RopeIndex];
+	State.AngleVelocity = AngleVelocity[RopeIndex];
+	State.PlaneNormal = FGH_SwingVector(PlaneNormal[RopeIndex].X, PlaneNormal[RopeIndex].Y, PlaneNormal[RopeIndex].Z);
+	State.ReelSpeed = ReelSpeed[RopeIndex];
+	return State;
+}
+
+void AGH_SwingManager::SetRopeState(int32 RopeIndex, const FGH_PendulumState& State)
+{
+	check(Owners.IsValidIndex(RopeIndex));
+
+	RopeLength[RopeIndex] = State.RopeLength;
+	Angle[RopeIndex] = State.Angle;
+	AngleVelocity[RopeIndex] = State.AngleVelocity;
+	PreviousAngle[RopeIndex] = State.Angle;
+	ReelSpeed[RopeIndex] = State.ReelSpeed;
+	SinAngle[RopeIndex] = FMath::Sin(State.Angle);
+	CosAngle[RopeIndex] = FMath::Cos(State.Angle);
+	PlaneNormal[RopeIndex] = FVector(State.PlaneNormal.X, State.PlaneNormal.Y, State.PlaneNormal.Z);
+}
+
+void AGH_SwingManager::SetRopeState(int32 RopeIndex, const FGH_PendulumState& State, float InPreviousAngle)
+{
+	SetRopeState(RopeIndex, State);
+	PreviousAngle[RopeIndex] = InPreviousAngle;
+}
+
+void AGH_SwingManager::SetRopeMoveDriven(int32 RopeIndex, bool bMoveDriven)
+{
+	check(Owners.IsValidIndex(RopeIndex));
+
+	NumMoveDrivenRopes += (bMoveDriven ? 1 : 0) - (RopeMoveDriven[RopeIndex] ? 1 : 0);
+	RopeMoveDriven[RopeIndex] = bMoveDriven;
+}
+
+void AGH_SwingManager::AccelerateRopeAnchor(int32 RopeIndex, const FVector& Acceleration, float Seconds)
+{
+	check(Owners.IsValidIndex(RopeIndex));
+
+	FGH_PendulumState State = GetRopeState(RopeIndex);
+	FGH_Pendulum::AccelerateAnchor(State, FGH_SwingVector(Acceleration.X, Acceleration.Y, Acceleration.Z), Seconds);
+	AngleVelocity[RopeIndex] = State.AngleVelocity;
+}
+
+void AGH_SwingManager::SetFollowsAnchors(AGH_Character* Character, bool bFollows)
+{
+	if (bFollows)
+	{
+		AnchorFollowers.AddUnique(Character);
+	}
+	else
+	{
+		AnchorFollowers.RemoveSwap(Character);
+	}
+}
+
+int32 AGH_SwingManager::RegisterBody(AGH_Character* Character, const FVector& Position, const FVector& Velocity)
+{
+	const int32 BodyIndex = BodyOwners.Add(Character);
+
+	BodyPosition.Add(Position);
+	BodyVelocity.Add(Velocity);
+	PreviousBodyPosition.Add(Position);
+	BodyNumRopes.Add(0);
+	BodyAnchors.AddZeroed(GH_MAX_ROPES_PER_BODY);
+	BodyRopeLengths.AddZeroed(GH_MAX_ROPES_PER_BODY);
+
+	return BodyIndex;
+}
+
+void AGH_SwingManager::UnregisterBody(int32 BodyIndex)
+{
+	check(BodyOwners.IsValidIndex(BodyIndex));
+
+	NumBodyRopes -= BodyNumRopes[BodyIndex];
+
+	BodyOwners.RemoveAtSwap(BodyIndex, 1, false);
+	BodyPosition.RemoveAtSwap(BodyIndex, 1, false);
+	BodyVelocity.RemoveAtSwap(BodyIndex, 1, false);
+	PreviousBodyPosition.RemoveAtSwap(BodyIndex, 1, false);
+	BodyNumRopes.RemoveAtSwap(BodyIndex, 1, false);
+
+	// Same swap on the rope blocks
+	const int32 LastBody = BodyOwners.Num();
+	if (BodyIndex != LastBody)
+	{
+		FMemory::Memcpy(&BodyAnchors[BodyIndex * GH_MAX_ROPES_PER_BODY], &BodyAnchors[LastBody * GH_MAX_ROPES_PER_BODY], GH_MAX_ROPES_PER_BODY * sizeof(FVector));
+		FMemory::Memcpy(&BodyRopeLengths[BodyIndex * GH_MAX_ROPES_PER_BODY], &BodyRopeLengths[LastBody * GH_MAX_ROPES_PER_BODY], GH_MAX_ROPES_PER_BODY * sizeof(float));
+	}
+	BodyAnchors.RemoveAt(LastBody * GH_MAX_ROPES_PER_BODY, GH_MAX_ROPES_PER_BODY, false);
+	BodyRopeLengths.RemoveAt(LastBody * GH_MAX_ROPES_PER_BODY, GH_MAX_ROPES_PER_BODY, false);
+
+	// The last body took the freed slot
+	if (BodyOwners.IsValidIndex(BodyIndex))
+	{
+		BodyOwners[BodyIndex]->SetRopeBodyIndex(BodyIndex);
+	}
+}
+
+void AGH_SwingManager::SetBodyRopes(int32 BodyIndex, const FVector* Anchors, const float* RopeLengths, int32 NumRopes)
+{
+	check(BodyOwners.IsValidIndex(BodyIndex) && NumRopes <= GH_MAX_ROPES_PER_BODY);
+
+	NumBodyRopes += NumRopes - BodyNumRopes[BodyIndex];
+	BodyNumRopes[BodyIndex] = NumRopes;
+	FMemory::Memcpy(&BodyAnchors[BodyIndex * GH_MAX_ROPES_PER_BODY], Anchors, NumRopes * sizeof(FVector));
+	FMemory::Memcpy(&BodyRopeLengths[BodyIndex * GH_MAX_ROPES_PER_BODY], RopeLengths, NumRopes * sizeof(float));
+}
+
+void AGH_SwingManager::GetBodyState(int32 BodyIndex, FVector& OutPosition, FVector& OutVelocity) const
+{
+	OutPosition = BodyPosition[BodyIndex];
+	OutVelocity = BodyVelocity[BodyIndex];
+}
+
+void AGH_SwingManager::SetBodyState(int32 BodyIndex, const FVector& Position, const FVector& Velocity)
+{
+	check(BodyOwners.IsValidIndex(BodyIndex));
+
+	BodyPosition[BodyIndex] = Position;
+	BodyVelocity[BodyIndex] = Velocity;
+	PreviousBodyPosition[BodyIndex] = Position;
+}
+
+FVector AGH_SwingManager::PredictBody(int32 BodyIndex, const FVector& Position, const FVector& Velocity, float DeltaSeconds) const
+{
+	FGH_SwingVector PredictedPosition(Position.X, Position.Y, Position.Z);
+	FGH_SwingVector PredictedVelocity(Velocity.X, Velocity.Y, Velocity.Z);
+	FGH_RopeConstraints::Step(PredictedPosition, PredictedVelocity, reinterpret_cast<const FGH_SwingVector*>(&BodyAnchors[BodyIndex * GH_MAX_ROPES_PER_BODY]),
+		&BodyRopeLengths[BodyIndex * GH_MAX_ROPES_PER_BODY], BodyNumRopes[BodyIndex], GetBodySettings(), DeltaSeconds);
+
+	return FVector(PredictedPosition.X, PredictedPosition.Y, PredictedPosition.Z);
+}
+
+FGH_RopeConstraintSettings AGH_SwingManager::GetBodySettings() const
+{
+	FGH_RopeConstraintSettings Settings;
+	Settings.Gravity = -GetWorld()->GetGravityZ();
+	Settings.SubSteps = SubSteps;
+	Settings.Iterations = ConstraintIterations;
+	return Settings;
+}
+
+FGH_PendulumSettings AGH_SwingManager::GetSettings() const
+{
+	FGH_PendulumSettings Settings;
+	Settings.Gravity = -GetWorld()->GetGravityZ();
+	Settings.FixedTimeStep = FixedTimeStep;
+	Settings.SubSteps = SubSteps;
+	Settings.MaxStepsPerFrame = MaxStepsPerFrame;
+	Settings.MinRopeLength = MinRopeLength;
+	Settings.MaxRopeLength = MaxRopeLength;
+	Settings.Integrator = static_cast<EGH_PendulumIntegrator>(Integrator);
+	return Settings;
+}
+
+void AGH_SwingManager::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	GH_SCOPE_CYCLE_COUNTER(SwingBatch);
+	FGH_ScopedFrameCycles FrameCycles(FGH_FrameCounters::Get().SwingCycles);
+
+	SET_DWORD_STAT(STAT_GH_LockedRopes, Owners.Num() + NumBodyRopes);
+	CSV_CUSTOM_STAT(Grappling, LockedRopes, Owners.Num() + NumBodyRopes, ECsvCustomStatOp::Set);
+
+	if (Owners.Num() == 0 && BodyOwners.Num() == 0)
+	{
+		TimeAccumulator = 0.f;
+		return;
+	}
+
+	const FGH_PendulumSettings Settings = GetSettings();
+	const uint32 StartCycles = FPlatformTime::Cycles();
+
+	// Consume the frame time in fixed steps so the swing does not depend on the frame rate
+	TimeAccumulator += DeltaSeconds;
+	int32 StepCount = 0;
+	while (TimeAccumulator >= Settings.FixedTimeStep && StepCount < Settings.MaxStepsPerFrame)
+	{
+		TimeAccumulator -= Settings.FixedTimeStep;
+		++StepCount;
+	}
+
+	// Too far behind after a hitch, drop the backlog instead of spiraling
+	if (TimeAccumulator >= Settings.FixedTimeStep)
+	{
+		TimeAccumulator = 0.f;
+	}
+	StepCounter += StepCount;
+
+	// Moving anchors are read once before the steps, they do not move between the steps of a frame.
+	// Backwards, a follower letting go of its ropes removes itself
+	if (StepCount > 0)
+	{
+		for (int32 FollowerIndex = AnchorFollowers.Num() - 1; FollowerIndex >= 0; --FollowerIndex)
+		{
+			if (AnchorFollowers[FollowerIndex] != nullptr)
+			{
+				AnchorFollowers[FollowerIndex]->FollowRopeAnchors();
+			}
+		}
+	}
+
+	// Counted once the followers let go of their ropes, releasing a rope swaps the arrays down
+	const int32 NumRopes = Owners.Num();
+	const int32 NumBodies = BodyOwners.Num();
+	if (NumRopes == 0 && NumBodies == 0)
+	{
+		return;
+	}
+
+	const float Alpha = TimeAccumulator / Settings.FixedTimeStep;
+
+	// The batch runs on whole groups of 4 ropes, the move driven ones are put back as they were afterwards
+	TArray<TTuple<int32, FGH_PendulumState, float>, TInlineAllocator<16>> MoveDrivenStates;
+	if (NumMoveDrivenRopes > 0 && StepCount > 0)
+	{
+		for (int32 RopeIndex = 0; RopeIndex < NumRopes; ++RopeIndex)
+		{
+			if (RopeMoveDriven[RopeIndex])
+			{
+				MoveDrivenStates.Emplace(RopeIndex, GetRopeState(RopeIndex), PreviousAngle[RopeIndex]);
+			}
+		}
+	}
+
+	// Ropes are independent, each batch runs all the steps of its ropes. Batches stay multiple of 4 for the vectorized kernel
+	const bool bParallel = CVarSwingParallel.GetValueOnGameThread() != 0 && FApp::ShouldUseThreading();
+	const int32 BatchSize = bParallel ? Align(FMath::Max(CVarSwingParallelBatchSize.GetValueOnGameThread(), 4), 4) : FMath::Max(NumRopes, 1);
+	const int32 NumBatches = FMath::DivideAndRoundUp(NumRopes, BatchSize);
+
+	FThreadSafeCounter64 BatchCycles;
+	ParallelFor(NumBatches, [&](int32 BatchIndex)
+	{
+		const uint32 BatchStartCycles = FPlatformTime::Cycles();
+		const int32 Begin = BatchIndex * BatchSize;
+		const int32 End = FMath::Min(Begin + BatchSize, NumRopes);
+
+		for (int32 Step = 0; Step < StepCount; ++Step)
+		{
+			StepRopes(Settings, Begin, End);
+		}
+		InterpolateRopes(Alpha, Begin, End);
+
+		BatchCycles.Add(FPlatformTime::Cycles() - BatchStartCycles);
+	}, !bParallel);
+
+	for (const TTuple<int32, FGH_PendulumState, float>& MoveDrivenState : MoveDrivenStates)
+	{
+		SetRopeState(MoveDrivenState.Get<0>(), MoveDrivenState.Get<1>(), MoveDrivenState.Get<2>());
+	}
+
+	// Few bodies compared to the single ropes, they are stepped on the game thread
+	if (NumBodies > 0)
+	{
+		const FGH_RopeConstraintSettings BodySettings = GetBodySettings();
+		for (int32 Step = 0; Step < StepCount; ++Step)
+		{
+			StepBodies(BodySettings, 0, NumBodies);
+		}
+	}
+
+	const uint32 ElapsedCycles = FPlatformTime::Cycles() - StartCycles;
+	const float ElapsedMs = FPlatformTime::ToMilliseconds(ElapsedCycles);
+	if (StepCount > 0 && ElapsedMs > 0.f)
+	{
+		SET_FLOAT_STAT(STAT_GH_RopesPerMs, NumRopes * StepCount / ElapsedMs);
+	}
+
+	// Solver time spent on the workers that the game thread did not wait for
+	SET_FLOAT_STAT(STAT_GH_SwingTimeSaved, bParallel ? FMath::Max(0.f, (float)(FPlatformTime::GetSecondsPerCycle64() * BatchCycles.GetValue() * 1000.0) - ElapsedMs) : 0.f);
+
+	// Move the characters on the game thread, backward so a rope released during the write-back does not skip another one
+	for (int32 RopeIndex = NumRopes - 1; RopeIndex >= 0; --RopeIndex)
+	{
+		if (!Owners.IsValidIndex(RopeIndex) || RopeMoveDriven[RopeIndex])
+		{
+			continue;
+		}
+
+		const float Length = RopeLength[RopeIndex];
+		const FVector Horizontal = FVector::CrossProduct(PlaneNormal[RopeIndex], FVector::UpVector);
+		Owners[RopeIndex]->ApplySwing(Horizontal * (SinAngle[RopeIndex] * Length) + FVector(0.f, 0.f, CosAngle[RopeIndex] * Length));
+	}
+
+	for (int32 BodyIndex = NumBodies - 1; BodyIndex >= 0; --BodyIndex)
+	{
+		if (BodyOwners.IsValidIndex(BodyIndex))
+		{
+			BodyOwners[BodyIndex]->ApplyRopeBody(FMath::Lerp(PreviousBodyPosition[BodyIndex], BodyPosition[BodyIndex], Alpha));
+		}
+	}
+}
+
+void AGH_SwingManager::StepBodies(const FGH_RopeConstraintSettings& Settings, int32 Begin, int32 End)
+{
+	FGH_SwingVector* RESTRICT PositionData = reinterpret_cast<FGH_SwingVector*>(BodyPosition.GetData());
+	FGH_SwingVector* RESTRICT VelocityData = reinterpret_cast<FGH_SwingVector*>(BodyVelocity.GetData());
+	const FGH_SwingVector* RESTRICT AnchorData = reinterpret_cast<const FGH_SwingVector*>(BodyAnchors.GetData());
+	const float* RESTRICT LengthData = BodyRopeLengths.GetData();
+
+	for (int32 BodyIndex = Begin; BodyIndex < End; ++BodyIndex)
+	{
+		PreviousBodyPosition[BodyIndex] = BodyPosition[BodyIndex];
+		FGH_RopeConstraints::Step(PositionData[BodyIndex], VelocityData[BodyIndex], AnchorData + BodyIndex * GH_MAX_ROPES_PER_BODY,
+			LengthData + BodyIndex * GH_MAX_ROPES_PER_BODY, BodyNumRopes[BodyIndex], Settings, FixedTimeStep);
+	}
+}
+
+void AGH_SwingManager::StepRopes(const FGH_PendulumSettings& Settings, int32 Begin, int32 End)
+{
+	float* RESTRICT AngleData = Angle.GetData();
+	float* RESTRICT VelocityData = AngleVelocity.GetData();
+	float* RESTRICT PreviousData = PreviousAngle.GetData();
+	float* RESTRICT LengthData = RopeLength.GetData();
+	float* RESTRICT ReelData = ReelSpeed.GetData();
+
+	if (Settings.Integrator != EGH_PendulumIntegrator::SemiImplicitEuler)
+	{
+		for (int32 RopeIndex = Begin; RopeIndex < End; ++RopeIndex)
+		{
+			FGH_PendulumState State;
+			State.RopeLength = LengthData[RopeIndex];
+			State.Angle = AngleData[RopeIndex];
+			State.AngleVelocity = VelocityData[RopeIndex];
+			State.ReelSpeed = ReelData[RopeIndex];
+
+			FGH_Pendulum::Step(State, Settings, Settings.FixedTimeStep);
+
+			PreviousData[RopeIndex] = AngleData[RopeIndex];
+			AngleData[RopeIndex] = State.Angle;
+			VelocityData[RopeIndex] = State.AngleVelocity;
+			LengthData[RopeIndex] = State.RopeLength;
+			ReelData[RopeIndex] = State.ReelSpeed;
+		}
+		return;
+	}
+
+	// Four ropes per instruction, see FGH_PendulumBatch
+	FGH_PendulumBatch::StepSemiImplicitEuler(AngleData + Begin, VelocityData + Begin, PreviousData + Begin, LengthData + Begin, ReelData + Begin, End - Begin, Settings);
+}
+
+void AGH_SwingManager::InterpolateRopes(float Alpha, int32 Begin, int32 End)
+{
+	const float* RESTRICT AngleData = Angle.GetData();
+	const float* RESTRICT PreviousData = PreviousAngle.GetData();
+	float* RESTRICT SinData = SinAngle.GetData();
+	float* RESTRICT CosData = CosAngle.GetData();
+
+	const VectorRegister VectorAlpha = VectorSetFloat1(Alpha);
+
+	int32 RopeIndex = Begin;
+	for (; RopeIndex + 4 <= End; RopeIndex += 4)
+	{
+		const VectorRegister VectorPrevious = VectorLoad(PreviousData + RopeIndex);
+		const VectorRegister VectorAngle = VectorMultiplyAdd(VectorSubtract(VectorLoad(AngleData + RopeIndex), VectorPrevious), VectorAlpha, VectorPrevious);
+
+		VectorRegister VectorSin, VectorCos;
+		VectorSinCos(&VectorSin, &VectorCos, &VectorAngle);
+		VectorStore(VectorSin, SinData + RopeIndex);
+		VectorStore(VectorCos, CosData + RopeIndex);
+	}
+
+	for (; RopeIndex < End; ++RopeIndex)
+	{
+		FMath::SinCos(&SinData[RopeIndex], &CosData[RopeIndex], FMath::Lerp(PreviousData[RopeIndex], AngleData[RopeIndex], Alpha));
+	}
+}
@@ -0,0 +1,194 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Algorithm/GH_Pendulum.h"
+#include "Algorithm/GH_RopeConstraints.h"
+#include "GH_SwingManager.generated.h"
+
+class AGH_Character;
+
+/** Numerical scheme used to advance the swing pendulum, mirrors EGH_PendulumIntegrator */
+UENUM(BlueprintType)
+enum class EGH_SwingIntegrator : uint8
+{
+	SemiImplicitEuler,
+	Verlet,
+	RK4
+};
+
+/**
+ * World-level solver advancing every locked rope in one batched pass per fixed step.
+ * Ropes are stored in structure-of-arrays form so the pendulum update runs four ropes at a time,
+ * split in batches integrated on the worker threads (see gh.Swing.Parallel).
+ * Characters held by several hooks are solved as bodies under rope constraints, their ropes stored contiguously per body.
+ */
+UCLASS(config = Game, notplaceable)
+class GRAPPLINGHOOD_API AGH_SwingManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	AGH_SwingManager();
+
+	/** Returns the swing manager of the world, spawning it on first use */
+	static AGH_SwingManager* Get(UWorld* World);
+
+	/** Duration of one swing solver step (in s), independent from the frame time */
+	UPROPERTY(EditAnywhere, Config, Category = Swing, meta = (ClampMin = "0.001"))
+	float FixedTimeStep = 1.f / 60.f;
+
+	/** Number of integration sub steps done inside each fixed step */
+	UPROPERTY(EditAnywhere, Config, Category = Swing, meta = (ClampMin = "1"))
+	int32 SubSteps = 2;
+
+	/** Maximum fixed steps run in one frame, the remaining time is dropped after a hitch */
+	UPROPERTY(EditAnywhere, Config, Category = Swing, meta = (ClampMin = "1"))
+	int32 MaxStepsPerFrame = 8;
+
+	/** Integration scheme of the swing solver, only semi-implicit Euler runs the vectorized kernel */
+	UPROPERTY(EditAnywhere, Config, Category = Swing)
+	EGH_SwingIntegrator Integrator = EGH_SwingIntegrator::SemiImplicitEuler;
+
+	/** Shortest rope a character can reel in to (in cm) */
+	UPROPERTY(EditAnywhere, Config, Category = Swing, meta = (ClampMin = "1"))
+	float MinRopeLength = 100.f;
+
+	/** Longest rope a character can reel out to (in cm) */
+	UPROPERTY(EditAnywhere, Config, Category = Swing, meta = (ClampMin = "1"))
+	float MaxRopeLength = 5000.f;
+
+	/** Passes over the ropes of a body held by several hooks per sub step */
+	UPROPERTY(EditAnywhere, Config, Category = Swing, meta = (ClampMin = "1"))
+	int32 ConstraintIterations = 4;
+
+	/** Starts simulating a locked rope, returns its index */
+	int32 RegisterRope(AGH_Character* Character, const FGH_PendulumState& State);
+
+	/** Stops simulating a rope, the last rope is moved to its index */
+	void UnregisterRope(int32 RopeIndex);
+
+	/** Returns the current solver state of a rope */
+	FGH_PendulumState GetRopeState(int32 RopeIndex) const;
+
+	/** Overwrites the solver state of a rope, used to apply a server correction */
+	void SetRopeState(int32 RopeIndex, const FGH_PendulumState& State);
+
+	/** Overwrites the solver state of a move driven rope and the angle before its last step, its moves interpolate between them */
+	void SetRopeState(int32 RopeIndex, const FGH_PendulumState& State, float InPreviousAngle);
+
+	FORCEINLINE float GetRopePreviousAngle(int32 RopeIndex) const { return PreviousAngle[RopeIndex]; }
+
+	/** Sets the rate the rope length changes at (in cm/s), negative to reel in */
+	FORCEINLINE void SetRopeReelSpeed(int32 RopeIndex, float Speed) { ReelSpeed[RopeIndex] = Speed; }
+
+	/**
+	 * Marks a rope as stepped by the moves of its character instead of the batch, e.g. a networked player on its client and on the server.
+	 * The batch leaves the state of such ropes untouched and does not move their character
+	 */
+	void SetRopeMoveDriven(int32 RopeIndex, bool bMoveDriven);
+
+	FORCEINLINE bool IsRopeMoveDriven(int32 RopeIndex) const { return RopeMoveDriven[RopeIndex]; }
+
+	/** Applies the acceleration of the anchor of a rope over Seconds, see FGH_Pendulum::AccelerateAnchor */
+	void AccelerateRopeAnchor(int32 RopeIndex, const FVector& Acceleration, float Seconds);
+
+	/** Adds or removes a character whose ropes hang from moving anchors, followed before the steps of each frame */
+	void SetFollowsAnchors(AGH_Character* Character, bool bFollows);
+
+	/** Builds the solver settings from the manager properties */
+	FGH_PendulumSettings GetSettings() const;
+
+	FORCEINLINE int32 GetNumRopes() const { return Owners.Num(); }
+
+	/** Starts simulating a character held by several ropes, returns its body index */
+	int32 RegisterBody(AGH_Character* Character, const FVector& Position, const FVector& Velocity);
+
+	/** Stops simulating a body, the last body is moved to its index */
+	void UnregisterBody(int32 BodyIndex);
+
+	/** Replaces the ropes holding a body, at most GH_MAX_ROPES_PER_BODY */
+	void SetBodyRopes(int32 BodyIndex, const FVector* Anchors, const float* RopeLengths, int32 NumRopes);
+
+	/** Returns the current solver state of a body */
+	void GetBodyState(int32 BodyIndex, FVector& OutPosition, FVector& OutVelocity) const;
+
+	/** Overwrites the solver state of a body, used when the body is blocked */
+	void SetBodyState(int32 BodyIndex, const FVector& Position, const FVector& Velocity);
+
+	/** Returns where the body would be after DeltaSeconds from the given state, the manager state is left untouched */
+	FVector PredictBody(int32 BodyIndex, const FVector& Position, const FVector& Velocity, float DeltaSeconds) const;
+
+	/** Builds the body solver settings from the manager properties */
+	FGH_RopeConstraintSettings GetBodySettings() const;
+
+	FORCEINLINE int32 GetNumBodies() const { return BodyOwners.Num(); }
+	FORCEINLINE int32 GetNumBodyRopes() const { return NumBodyRopes; }
+
+	/** Returns the number of fixed steps run so far, for the work done once per step outside the manager */
+	FORCEINLINE uint32 GetStepCounter() const { return StepCounter; }
+
+	virtual void Tick(float DeltaSeconds) override;
+
+protected:
+	/** Advances the ropes [Begin, End) by one fixed step */
+	void StepRopes(const FGH_PendulumSettings& Settings, int32 Begin, int32 End);
+
+	/** Computes the interpolated angle sine/cosine of the ropes [Begin, End) */
+	void InterpolateRopes(float Alpha, int32 Begin, int32 End);
+
+	/** Advances the bodies [Begin, End) by one fixed step */
+	void StepBodies(const FGH_RopeConstraintSettings& Settings, int32 Begin, int32 End);
+
+	/** Time not yet consumed by the solver */
+	float TimeAccumulator = 0.f;
+
+	/** Fixed steps run since the manager was spawned */
+	uint32 StepCounter = 0;
+
+	/** Characters owning each rope */
+	UPROPERTY(Transient)
+	TArray<AGH_Character*> Owners;
+
+	// Hot pendulum data, one entry per rope
+	TArray<float> RopeLength;
+	TArray<float> Angle;
+	TArray<float> AngleVelocity;
+	TArray<float> PreviousAngle;
+	TArray<float> ReelSpeed;
+
+	// Interpolated angle, written by InterpolateRopes for the write-back
+	TArray<float> SinAngle;
+	TArray<float> CosAngle;
+
+	// Cold per-rope data, only read by the write-back
+	TArray<FVector> PlaneNormal;
+	TArray<bool> RopeMoveDriven;
+
+	/** Ropes marked by SetRopeMoveDriven */
+	int32 NumMoveDrivenRopes = 0;
+
+	/** Characters owning each body */
+	UPROPERTY(Transient)
+	TArray<AGH_Character*> BodyOwners;
+
+	// Body data, one entry per body
+	TArray<FVector> BodyPosition;
+	TArray<FVector> BodyVelocity;
+	TArray<FVector> PreviousBodyPosition;
+	TArray<int32> BodyNumRopes;
+
+	// Ropes of the bodies, GH_MAX_ROPES_PER_BODY entries per body so the ropes of a body are contiguous
+	TArray<FVector> BodyAnchors;
+	TArray<float> BodyRopeLengths;
+
+	/** Ropes holding all the bodies */
+	int32 NumBodyRopes = 0;
+
+	/** Characters hanging from moving anchors, see SetFollowsAnchors */
+	UPROPERTY(Transient)
+	TArray<AGH_Character*> AnchorFollowers;
+};
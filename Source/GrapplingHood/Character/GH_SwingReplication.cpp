@@ -0,0 +1,198 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GH_SwingReplication.h"
+
+constexpr float FGH_SwingReplication::RopeLengthStep;
+constexpr float FGH_SwingReplication::MaxAngleVelocity;
+constexpr float FGH_SwingReplication::ReelSpeedStep;
+
+/** Maps an angle to 16 bits over a full turn */
+static uint16 QuantizeAngle(float Angle)
+{
+	float Turn = FMath::Fmod(Angle, 2.f * PI);
+	if (Turn < 0.f)
+	{
+		Turn += 2.f * PI;
+	}
+	return static_cast<uint16>(FMath::RoundToInt(Turn / (2.f * PI) * 65536.f) & 0xFFFF);
+}
+
+static float DequantizeAngle(uint16 Quantized)
+{
+	return Quantized * (2.f * PI / 65536.f);
+}
+
+/** Maps a value in [-Range, Range] to 16 signed bits */
+static int16 QuantizeSigned(float Value, float Range)
+{
+	return static_cast<int16>(FMath::Clamp(FMath::RoundToInt(Value / Range * 32767.f), -32767, 32767));
+}
+
+static float DequantizeSigned(int16 Quantized, float Range)
+{
+	return Quantized * (Range / 32767.f);
+}
+
+static int8 QuantizeReelSpeed(float ReelSpeed)
+{
+	return static_cast<int8>(FMath::Clamp(FMath::RoundToInt(ReelSpeed / FGH_SwingReplication::ReelSpeedStep), -127, 127));
+}
+
+FGH_QuantizedSwing FGH_QuantizedSwing::FromState(const FGH_PendulumState& State, uint8 InNumWraps)
+{
+	FGH_QuantizedSwing Swing;
+	Swing.RopeLength = static_cast<uint16>(FMath::Clamp(FMath::RoundToInt(State.RopeLength / FGH_SwingReplication::RopeLengthStep), 0, 65535));
+	Swing.Angle = QuantizeAngle(State.Angle);
+	Swing.AngleVelocity = QuantizeSigned(State.AngleVelocity, FGH_SwingReplication::MaxAngleVelocity);
+	Swing.NumWraps = InNumWraps;
+	return Swing;
+}
+
+void FGH_QuantizedSwing::ToState(FGH_PendulumState& State) const
+{
+	State.RopeLength = RopeLength * FGH_SwingReplication::RopeLengthStep;
+	State.Angle = DequantizeAngle(Angle);
+	State.AngleVelocity = DequantizeSigned(AngleVelocity, FGH_SwingReplication::MaxAngleVelocity);
+}
+
+FGH_SwingReplication FGH_SwingReplication::FromState(const FGH_PendulumState& State, uint8 InLockId, uint8 InNumWraps)
+{
+	FGH_SwingReplication Replication;
+	Replication.RopeLength = FMath::Clamp(FMath::RoundToFloat(State.RopeLength / RopeLengthStep), 0.f, 65535.f) * RopeLengthStep;
+	Replication.Angle = DequantizeAngle(QuantizeAngle(State.Angle));
+	Replication.AngleVelocity = DequantizeSigned(QuantizeSigned(State.AngleVelocity, MaxAngleVelocity), MaxAngleVelocity);
+	Replication.PlaneYaw = DequantizeAngle(QuantizeAngle(FMath::Atan2(State.PlaneNormal.Y, State.PlaneNormal.X)));
+	Replication.ReelSpeed = QuantizeReelSpeed(State.ReelSpeed) * ReelSpeedStep;
+	Replication.LockId = InLockId;
+	Replication.NumWraps = InNumWraps;
+	return Replication;
+}
+
+FGH_PendulumState FGH_SwingReplication::ToState() const
+{
+	FGH_PendulumState State;
+	State.RopeLength = RopeLength;
+	State.Angle = Angle;
+	State.AngleVelocity = AngleVelocity;
+	// Locked ropes swing in a vertical plane, the normal is horizontal
+	State.PlaneNormal = FGH_SwingVector(FMath::Cos(PlaneYaw), FMath::Sin(PlaneYaw), 0.f);
+	State.ReelSpeed = ReelSpeed;
+	return State;
+}
+
+bool FGH_SwingReplication::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+{
+	uint16 QuantizedLength = static_cast<uint16>(FMath::Clamp(FMath::RoundToInt(RopeLength / RopeLengthStep), 0, 65535));
+	uint16 QuantizedAngle = QuantizeAngle(Angle);
+	int16 QuantizedVelocity = QuantizeSigned(AngleVelocity, MaxAngleVelocity);
+	uint16 QuantizedYaw = QuantizeAngle(PlaneYaw);
+	int8 QuantizedReel = QuantizeReelSpeed(ReelSpeed);
+
+	Ar << QuantizedLength;
+	Ar << QuantizedAngle;
+	Ar << QuantizedVelocity;
+	Ar << QuantizedYaw;
+	Ar << QuantizedReel;
+	Ar << LockId;
+	Ar << NumWraps;
+
+	if (Ar.IsLoading())
+	{
+		RopeLength = QuantizedLength * RopeLengthStep;
+		Angle = DequantizeAngle(QuantizedAngle);
+		AngleVelocity = DequantizeSigned(QuantizedVelocity, MaxAngleVelocity);
+		PlaneYaw = DequantizeAngle(QuantizedYaw);
+		ReelSpeed = QuantizedReel * ReelSpeedStep;
+	}
+
+	bOutSuccess = true;
+	return true;
+}
+
+/** Maps signed values to unsigned ones, small magnitudes staying small */
+static uint32 ZigZagEncode(int32 Value)
+{
+	return (static_cast<uint32>(Value) << 1) ^ static_cast<uint32>(Value >> 31);
+}
+
+static int32 ZigZagDecode(uint32 Value)
+{
+	return static_cast<int32>(Value >> 1) ^ -static_cast<int32>(Value & 1);
+}
+
+/** Bits written by FArchive::SerializeIntPacked, 8 bits per 7 bits of value */
+static int32 GetPackedNumBits(uint32 Value)
+{
+	int32 NumBits = 8;
+	while (Value >= 0x80)
+	{
+		Value >>= 7;
+		NumBits += 8;
+	}
+	return NumBits;
+}
+
+FGH_SwingMoveData FGH_SwingMoveData::Encode(uint8 InMoveId, const FGH_QuantizedSwing& Swing, const FGH_QuantizedSwing* Base, uint8 InBaseMoveId)
+{
+	FGH_SwingMoveData Data;
+	Data.MoveId = InMoveId;
+	Data.BaseMoveId = Base != nullptr ? InBaseMoveId : InMoveId;
+	Data.NumWraps = Swing.NumWraps;
+
+	if (Data.IsRelative())
+	{
+		Data.RopeLength = static_cast<int32>(Swing.RopeLength) - Base->RopeLength;
+		// Angles wrap around, take the shortest difference
+		Data.Angle = static_cast<int16>(static_cast<uint16>(Swing.Angle - Base->Angle));
+		Data.AngleVelocity = static_cast<int32>(Swing.AngleVelocity) - Base->AngleVelocity;
+	}
+	else
+	{
+		Data.RopeLength = Swing.RopeLength;
+		Data.Angle = static_cast<int16>(Swing.Angle);
+		Data.AngleVelocity = Swing.AngleVelocity;
+	}
+
+	return Data;
+}
+
+FGH_QuantizedSwing FGH_SwingMoveData::Decode(const FGH_QuantizedSwing* Base) const
+{
+	FGH_QuantizedSwing Swing;
+	const bool bRelative = IsRelative() && Base != nullptr;
+	Swing.RopeLength = static_cast<uint16>((bRelative ? Base->RopeLength : 0) + RopeLength);
+	Swing.Angle = static_cast<uint16>((bRelative ? Base->Angle : 0) + Angle);
+	Swing.AngleVelocity = static_cast<int16>((bRelative ? Base->AngleVelocity : 0) + AngleVelocity);
+	Swing.NumWraps = NumWraps;
+	return Swing;
+}
+
+int32 FGH_SwingMoveData::GetNumBits() const
+{
+	return 56 + GetPackedNumBits(ZigZagEncode(RopeLength)) + GetPackedNumBits(ZigZagEncode(Angle)) + GetPackedNumBits(ZigZagEncode(AngleVelocity));
+}
+
+bool FGH_SwingMoveData::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+{
+	uint32 PackedLength = ZigZagEncode(RopeLength);
+	uint32 PackedAngle = ZigZagEncode(Angle);
+	uint32 PackedVelocity = ZigZagEncode(AngleVelocity);
+
+	Ar << MoveId;
+	Ar << BaseMoveId;
+	Ar << TimeStamp;
+	Ar << NumWraps;
+	Ar.SerializeIntPacked(PackedLength);
+	Ar.SerializeIntPacked(PackedAngle);
+	Ar.SerializeIntPacked(PackedVelocity);
+
+	if (Ar.IsLoading())
+	{
+		RopeLength = ZigZagDecode(PackedLength);
+		Angle = ZigZagDecode(PackedAngle);
+		AngleVelocity = ZigZagDecode(PackedVelocity);
+	}
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
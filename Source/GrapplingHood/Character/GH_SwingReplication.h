@@ -0,0 +1,175 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/NetSerialization.h"
+#include "Algorithm/GH_Pendulum.h"
+#include "GH_SwingReplication.generated.h"
+
+/** Hook state of a character as seen by the server */
+USTRUCT()
+struct FGH_HookReplication
+{
+	GENERATED_BODY()
+
+	/** AGH_Hook::State */
+	UPROPERTY()
+	uint8 State = 0;
+
+	/** Incremented at each fire, lets the owning client drop the states older than its prediction */
+	UPROPERTY()
+	uint8 ShotId = 0;
+
+	/** Fire direction */
+	UPROPERTY()
+	FVector_NetQuantizeNormal Direction;
+
+	/** Attach point of the hook once hooked */
+	UPROPERTY()
+	FVector_NetQuantize10 Anchor;
+
+	/** Movable component the hook is attached to, null on the static world or when the component cannot be referenced over the network */
+	UPROPERTY()
+	class UPrimitiveComponent* AnchorComponent = nullptr;
+};
+
+/** Point the primary rope wraps around, as decided by the server */
+USTRUCT()
+struct FGH_RopeWrapReplication
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FVector_NetQuantize10 Location;
+
+	/** Bend of the rope when it wrapped */
+	UPROPERTY()
+	FVector_NetQuantizeNormal BendNormal;
+};
+
+/** Rope length, angle and angular velocity quantized like FGH_SwingReplication */
+struct FGH_QuantizedSwing
+{
+	uint16 RopeLength = 0;
+	uint16 Angle = 0;
+	int16 AngleVelocity = 0;
+
+	/** Wrap points of the rope, the pendulum swings around the last one */
+	uint8 NumWraps = 0;
+
+	static FGH_QuantizedSwing FromState(const FGH_PendulumState& State, uint8 InNumWraps = 0);
+
+	/** Writes the quantized values into the state, the swing plane is left untouched */
+	void ToState(FGH_PendulumState& State) const;
+};
+
+/**
+ * Pendulum state of a locked rope, quantized to 11 bytes:
+ * rope length on 16 bits (0.5 cm steps), angle and swing plane yaw on 16 bits, angular velocity on 16 signed bits,
+ * reel speed on 8 signed bits (10 cm/s steps), wrap count on 8 bits.
+ * The pendulum swings around the last wrap point, the state only applies with the same wrap points.
+ */
+USTRUCT()
+struct FGH_SwingReplication
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	float RopeLength = 0.f;
+
+	UPROPERTY()
+	float Angle = 0.f;
+
+	UPROPERTY()
+	float AngleVelocity = 0.f;
+
+	/** Yaw of the swing plane normal (in rad) */
+	UPROPERTY()
+	float PlaneYaw = 0.f;
+
+	UPROPERTY()
+	float ReelSpeed = 0.f;
+
+	/** Incremented by the server at each lock, tells the clients a new swing started */
+	UPROPERTY()
+	uint8 LockId = 0;
+
+	/** Wrap points of the rope when the state was taken */
+	UPROPERTY()
+	uint8 NumWraps = 0;
+
+	/** Builds the replicated state, quantized like it is received */
+	static FGH_SwingReplication FromState(const FGH_PendulumState& State, uint8 InLockId, uint8 InNumWraps);
+
+	/** Rebuilds the solver state */
+	FGH_PendulumState ToState() const;
+
+	/** Packs the state in a few bytes */
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+	/** Rope length step (in cm) */
+	static constexpr float RopeLengthStep = 0.5f;
+	/** Largest angular velocity sent (in rad/s) */
+	static constexpr float MaxAngleVelocity = 20.f;
+	/** Reel speed step (in cm/s) */
+	static constexpr float ReelSpeedStep = 10.f;
+};
+
+template<>
+struct TStructOpsTypeTraits<FGH_SwingReplication> : public TStructOpsTypeTraitsBase2<FGH_SwingReplication>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
+/**
+ * Swing state of a client move, sent with the move to the server.
+ * Encoded as a difference with a move the server acknowledged, in variable length integers, a few bytes per move.
+ */
+USTRUCT()
+struct FGH_SwingMoveData
+{
+	GENERATED_BODY()
+
+	/** Id of the move */
+	uint8 MoveId = 0;
+
+	/** Id of the move the values are relative to, the values are absolute when equal to MoveId */
+	uint8 BaseMoveId = 0;
+
+	/** Client time stamp of the move, the server applies the swing when it runs the move */
+	float TimeStamp = 0.f;
+
+	/** Quantized values, or differences with the base move */
+	int32 RopeLength = 0;
+	int32 Angle = 0;
+	int32 AngleVelocity = 0;
+
+	/** Wrap points of the client rope, always absolute */
+	uint8 NumWraps = 0;
+
+	/** Builds the data of a move, relative to Base if given */
+	static FGH_SwingMoveData Encode(uint8 InMoveId, const FGH_QuantizedSwing& Swing, const FGH_QuantizedSwing* Base, uint8 InBaseMoveId);
+
+	/** Rebuilds the move values, Base must be the state of BaseMoveId when the data is relative */
+	FGH_QuantizedSwing Decode(const FGH_QuantizedSwing* Base) const;
+
+	FORCEINLINE bool IsRelative() const { return BaseMoveId != MoveId; }
+
+	/** Size of the data once serialized */
+	int32 GetNumBits() const;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FGH_SwingMoveData> : public TStructOpsTypeTraitsBase2<FGH_SwingMoveData>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
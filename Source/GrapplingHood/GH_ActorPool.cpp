@@ -0,0 +1,160 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GH_ActorPool.h"
+#include "GrapplingHood.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGHActorPool, Log, All);
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pool hits"), STAT_GH_PoolHits, STATGROUP_Grappling);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pool misses"), STAT_GH_PoolMisses, STATGROUP_Grappling);
+
+// Sets default values
+AGH_ActorPool::AGH_ActorPool()
+{
+	PrimaryActorTick.bCanEverTick = false;
+}
+
+AGH_ActorPool* AGH_ActorPool::Get(UWorld* World)
+{
+	if (World == nullptr)
+	{
+		return nullptr;
+	}
+
+	for (TActorIterator<AGH_ActorPool> It(World); It; ++It)
+	{
+		return *It;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.ObjectFlags |= RF_Transient;
+	return World->SpawnActor<AGH_ActorPool>(SpawnParams);
+}
+
+void AGH_ActorPool::Prewarm(UClass* Class, int32 Count)
+{
+	if (Class == nullptr)
+	{
+		return;
+	}
+
+	const int32 TargetCount = Count < 0 ? DefaultPrewarmCount : Count;
+
+	// Looked up again after each spawn, the spawned actor may add buckets from its BeginPlay
+	while (Buckets.FindOrAdd(Class).NumSpawned < TargetCount)
+	{
+		AActor* Actor = SpawnPooledActor(Class, GetActorTransform(), nullptr, nullptr);
+		if (Actor == nullptr)
+		{
+			break;
+		}
+		Release(Actor);
+	}
+}
+
+AActor* AGH_ActorPool::Acquire(UClass* Class, const FTransform& Transform, AActor* NewOwner, APawn* NewInstigator)
+{
+	if (Class == nullptr)
+	{
+		return nullptr;
+	}
+
+	FGH_ActorPoolBucket& Bucket = Buckets.FindOrAdd(Class);
+
+	// Skip the actors destroyed while pooled (e.g. by a level unload)
+	AActor* Actor = nullptr;
+	while (Actor == nullptr && Bucket.FreeActors.Num() > 0)
+	{
+		AActor* Candidate = Bucket.FreeActors.Pop(false);
+		if (Candidate != nullptr && !Candidate->IsPendingKill())
+		{
+			Actor = Candidate;
+		}
+	}
+
+	if (Actor != nullptr)
+	{
+		++NumHits;
+		INC_DWORD_STAT(STAT_GH_PoolHits);
+
+		Actor->SetActorTransform(Transform, false, nullptr, ETeleportType::TeleportPhysics);
+		Actor->SetOwner(NewOwner);
+		Actor->Instigator = NewInstigator;
+		Actor->SetActorHiddenInGame(false);
+		Actor->SetActorEnableCollision(true);
+		Actor->SetActorTickEnabled(Actor->PrimaryActorTick.bStartWithTickEnabled);
+	}
+	else
+	{
+		++NumMisses;
+		INC_DWORD_STAT(STAT_GH_PoolMisses);
+
+		Actor = SpawnPooledActor(Class, Transform, NewOwner, NewInstigator);
+	}
+
+	if (IGH_Poolable* Poolable = Cast<IGH_Poolable>(Actor))
+	{
+		Poolable->OnAcquiredFromPool(this);
+	}
+
+	return Actor;
+}
+
+void AGH_ActorPool::Release(AActor* Actor)
+{
+	if (Actor == nullptr || Actor->IsPendingKill())
+	{
+		return;
+	}
+
+	FGH_ActorPoolBucket* Bucket = Buckets.Find(Actor->GetClass());
+	if (Bucket == nullptr)
+	{
+		// Not created by the pool
+		Actor->Destroy();
+		return;
+	}
+
+	// Pooled twice, two Acquire calls would hand out the same actor
+	if (!ensureMsgf(!Bucket->FreeActors.Contains(Actor), TEXT("%s released to the pool twice"), *Actor->GetName()))
+	{
+		return;
+	}
+
+	if (IGH_Poolable* Poolable = Cast<IGH_Poolable>(Actor))
+	{
+		Poolable->OnReleasedToPool();
+	}
+
+	Actor->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+	Actor->SetActorTickEnabled(false);
+	Actor->SetLifeSpan(0.f);
+
+	Bucket->FreeActors.Add(Actor);
+}
+
+void AGH_ActorPool::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UE_LOG(LogGHActorPool, Log, TEXT("Actor pool: %d hits, %d misses"), NumHits, NumMisses);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+AActor* AGH_ActorPool::SpawnPooledActor(UClass* Class, const FTransform& Transform, AActor* NewOwner, APawn* NewInstigator)
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.Owner = NewOwner;
+	SpawnParams.Instigator = NewInstigator;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	AActor* Actor = GetWorld()->SpawnActor(Class, &Transform, SpawnParams);
+	if (Actor != nullptr)
+	{
+		++Buckets.FindOrAdd(Class).NumSpawned;
+	}
+	return Actor;
+}
@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "UObject/Interface.h"
+#include "GH_ActorPool.generated.h"
+
+class AGH_ActorPool;
+
+UINTERFACE(MinimalAPI)
+class UGH_Poolable : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/** Actors resetting their own state when recycled by AGH_ActorPool */
+class GRAPPLINGHOOD_API IGH_Poolable
+{
+	GENERATED_BODY()
+
+public:
+	/** Called when the pool hands the actor out, after it has been moved to its new transform */
+	virtual void OnAcquiredFromPool(AGH_ActorPool* Pool) {}
+
+	/** Called when the actor goes back to the pool, before it is hidden */
+	virtual void OnReleasedToPool() {}
+};
+
+/** Inactive actors of one class */
+USTRUCT()
+struct FGH_ActorPoolBucket
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Transient)
+	TArray<AActor*> FreeActors;
+
+	/** Actors of the class spawned by the pool, in use or not */
+	int32 NumSpawned = 0;
+};
+
+/**
+ * World-level pool recycling short lived actors (hooks, projectiles) instead of spawning and destroying them.
+ * Released actors are hidden with their collision and tick disabled until handed out again.
+ */
+UCLASS(config = Game, notplaceable)
+class GRAPPLINGHOOD_API AGH_ActorPool : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	AGH_ActorPool();
+
+	/** Returns the actor pool of the world, spawning it on first use */
+	static AGH_ActorPool* Get(UWorld* World);
+
+	/** Actors of a class spawned up front by Prewarm when no count is given */
+	UPROPERTY(EditAnywhere, Config, Category = Pool, meta = (ClampMin = "0"))
+	int32 DefaultPrewarmCount = 8;
+
+	/** Spawns inactive actors until the pool created Count actors of the class (DefaultPrewarmCount if negative) */
+	void Prewarm(UClass* Class, int32 Count = -1);
+
+	/** Hands out an actor of the class, recycled when possible */
+	AActor* Acquire(UClass* Class, const FTransform& Transform, AActor* NewOwner = nullptr, APawn* NewInstigator = nullptr);
+
+	template<class T>
+	T* Acquire(TSubclassOf<T> Class, const FTransform& Transform, AActor* NewOwner = nullptr, APawn* NewInstigator = nullptr)
+	{
+		return CastChecked<T>(Acquire(*Class, Transform, NewOwner, NewInstigator), ECastCheckedType::NullAllowed);
+	}
+
+	/** Gives an actor back, it is deactivated until acquired again */
+	void Release(AActor* Actor);
+
+	/** Returns the number of Acquire calls served by a recycled actor **/
+	FORCEINLINE int32 GetNumHits() const { return NumHits; }
+	/** Returns the number of Acquire calls that had to spawn an actor **/
+	FORCEINLINE int32 GetNumMisses() const { return NumMisses; }
+
+protected:
+	// Called when the pool is removed from the world
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Spawns a new actor of the class for the pool */
+	AActor* SpawnPooledActor(UClass* Class, const FTransform& Transform, AActor* NewOwner, APawn* NewInstigator);
+
+	UPROPERTY(Transient)
+	TMap<UClass*, FGH_ActorPoolBucket> Buckets;
+
+	int32 NumHits = 0;
+	int32 NumMisses = 0;
+};
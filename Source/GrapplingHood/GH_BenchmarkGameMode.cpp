@@ -0,0 +1,247 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GH_BenchmarkGameMode.h"
+#include "GrapplingHood.h"
+#include "GH_ActorPool.h"
+#include "Character/GH_Character.h"
+#include "Character/GH_SwingManager.h"
+#include "Character/GH_AnchorIndex.h"
+#include "Character/GH_SwingBotController.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Kismet/GameplayStatics.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/App.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGHBenchmark, Log, All);
+
+AGH_BenchmarkGameMode::AGH_BenchmarkGameMode()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	// Sample once the characters, hooks and ropes ticked
+	PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+}
+
+void AGH_BenchmarkGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+	NumBots = UGameplayStatics::GetIntOption(Options, TEXT("Bots"), NumBots);
+	Duration = UGameplayStatics::HasOption(Options, TEXT("Duration")) ? FCString::Atof(*UGameplayStatics::ParseOption(Options, TEXT("Duration"))) : Duration;
+	Warmup = UGameplayStatics::HasOption(Options, TEXT("Warmup")) ? FCString::Atof(*UGameplayStatics::ParseOption(Options, TEXT("Warmup"))) : Warmup;
+	bSwingBots = UGameplayStatics::GetIntOption(Options, TEXT("SwingBots"), bSwingBots ? 1 : 0) != 0;
+	HooksPerBot = FMath::Clamp(UGameplayStatics::GetIntOption(Options, TEXT("Hooks"), HooksPerBot), 1, GH_MAX_ROPES_PER_BODY);
+}
+
+void AGH_BenchmarkGameMode::StartPlay()
+{
+	Super::StartPlay();
+
+	UClass* BotClass = DefaultPawnClass != nullptr && DefaultPawnClass->IsChildOf(AGH_Character::StaticClass()) ? *DefaultPawnClass : AGH_Character::StaticClass();
+
+	// Bots on a square grid around the player start
+	const AActor* Start = FindPlayerStart(nullptr);
+	const FVector Origin = Start != nullptr ? Start->GetActorLocation() : FVector::ZeroVector;
+	const int32 GridSize = FMath::CeilToInt(FMath::Sqrt((float)NumBots));
+
+	// Without a swing graph the bots fall back to the fixed schedule
+	const AGH_AnchorIndex* AnchorIndex = AGH_AnchorIndex::Get(GetWorld());
+	bSwingBots = bSwingBots && AnchorIndex != nullptr && AnchorIndex->GetNumSwingLinks() > 0;
+
+	for (int32 BotIndex = 0; BotIndex < NumBots; ++BotIndex)
+	{
+		const FVector Location = Origin + FVector((BotIndex % GridSize - GridSize / 2) * BotSpacing, (BotIndex / GridSize - GridSize / 2) * BotSpacing, 0.f);
+		const FTransform Transform(FRotator(0.f, 360.f * BotIndex / FMath::Max(NumBots, 1), 0.f), Location);
+
+		// Deferred so the hook count is set before BeginPlay takes the hooks from the pool
+		AGH_Character* Bot = GetWorld()->SpawnActorDeferred<AGH_Character>(BotClass, Transform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn);
+		if (Bot != nullptr)
+		{
+			Bot->NumHooks = HooksPerBot;
+			Bot->FinishSpawning(Transform);
+
+			if (bSwingBots)
+			{
+				Bot->AIControllerClass = AGH_SwingBotController::StaticClass();
+			}
+			Bot->SpawnDefaultController();
+			Bot->GetCharacterMovement()->bRunPhysicsWithNoController = true;
+			Bots.Add(Bot);
+		}
+	}
+
+	StartTime = GetWorld()->GetTimeSeconds();
+	Samples.Reserve(FMath::CeilToInt((Duration + Warmup) * 120.f));
+	FGH_FrameCounters::Get().Reset();
+
+	UE_LOG(LogGHBenchmark, Log, TEXT("Benchmark started with %d %s bots of %d hooks, %.0f s warmup, %.0f s measured"), Bots.Num(), bSwingBots ? TEXT("swing graph") : TEXT("scheduled"), HooksPerBot, Warmup, Duration);
+}
+
+void AGH_BenchmarkGameMode::UpdateBots(float Now)
+{
+	// Driven by their controller
+	if (bSwingBots)
+	{
+		return;
+	}
+
+	for (int32 BotIndex = 0; BotIndex < Bots.Num(); ++BotIndex)
+	{
+		AGH_Character* Bot = Bots[BotIndex];
+		if (Bot == nullptr || Bot->GetHookInstance() == nullptr)
+		{
+			continue;
+		}
+
+		// Bots are spread over the cycle so they do not all fire on the same frame
+		const float CycleTime = FMath::Fmod(Now + CyclePeriod * BotIndex / FMath::Max(Bots.Num(), 1), CyclePeriod);
+		const TArray<AGH_Hook*>& BotHooks = Bot->GetHooks();
+
+		if (CycleTime < CyclePeriod * HookedFraction)
+		{
+			// The hooks fan out around the bot heading, FireHookTowards skips the ones already fired
+			for (int32 HookIndex = 0; HookIndex < BotHooks.Num(); ++HookIndex)
+			{
+				const float Yaw = Bot->GetActorRotation().Yaw + (HookIndex - (BotHooks.Num() - 1) * 0.5f) * HookSpreadYaw;
+				Bot->FireHookTowards(FRotator(45.f, Yaw, 0.f).Vector(), HookIndex);
+			}
+		}
+		else
+		{
+			Bot->ReleaseAllHooks();
+		}
+	}
+}
+
+void AGH_BenchmarkGameMode::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (bFinished)
+	{
+		return;
+	}
+
+	FGH_FrameCounters& Counters = FGH_FrameCounters::Get();
+	const float Elapsed = GetWorld()->GetTimeSeconds() - StartTime;
+
+	if (Elapsed >= Warmup)
+	{
+		int32 ActiveHooks = 0;
+		for (const AGH_Character* Bot : Bots)
+		{
+			if (Bot == nullptr)
+			{
+				continue;
+			}
+
+			for (const AGH_Hook* BotHook : Bot->GetHooks())
+			{
+				ActiveHooks += BotHook->GetState() != AGH_Hook::State::DOCKED ? 1 : 0;
+			}
+		}
+
+		const AGH_SwingManager* SwingManager = AGH_SwingManager::Get(GetWorld());
+
+		FFrameSample Sample;
+		Sample.Time = Elapsed - Warmup;
+		Sample.FrameMs = FApp::GetDeltaTime() * 1000.f;
+		Sample.GameThreadMs = FPlatformTime::ToMilliseconds(GGameThreadTime);
+		Sample.CharacterTickMs = FPlatformTime::ToMilliseconds(Counters.CharacterTickCycles);
+		Sample.HookTickMs = FPlatformTime::ToMilliseconds(Counters.HookTickCycles);
+		Sample.SwingMs = FPlatformTime::ToMilliseconds(Counters.SwingCycles);
+		Sample.ActiveHooks = ActiveHooks;
+		Sample.RopeWrapTraces = Counters.RopeWrapTraces;
+		Sample.LockedRopes = SwingManager != nullptr ? SwingManager->GetNumRopes() + SwingManager->GetNumBodyRopes() : 0;
+		Sample.UsedMemoryMB = FPlatformMemory::GetStats().UsedPhysical / (1024.f * 1024.f);
+		Samples.Add(Sample);
+	}
+	Counters.Reset();
+
+	if (Elapsed >= Warmup + Duration)
+	{
+		FinishBenchmark();
+		return;
+	}
+
+	UpdateBots(Elapsed);
+}
+
+/** Value at the given fraction of the sorted samples */
+static float GetPercentile(TArray<float>& Values, float Fraction)
+{
+	if (Values.Num() == 0)
+	{
+		return 0.f;
+	}
+
+	Values.Sort();
+	return Values[FMath::Clamp(FMath::FloorToInt(Fraction * Values.Num()), 0, Values.Num() - 1)];
+}
+
+void AGH_BenchmarkGameMode::FinishBenchmark()
+{
+	bFinished = true;
+
+	const FString BaseName = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Benchmarks"), FString::Printf(TEXT("Grappling-%s"), *FDateTime::Now().ToString()));
+
+	FString Csv = TEXT("Time,FrameMs,GameThreadMs,CharacterTickMs,HookTickMs,SwingMs,ActiveHooks,LockedRopes,RopeWrapTraces,UsedMemoryMB\n");
+	TArray<float> FrameMs, GameThreadMs;
+	double TotalFrameMs = 0.0, TotalGameThreadMs = 0.0, CharacterTickMs = 0.0, HookTickMs = 0.0, SwingMs = 0.0;
+	int64 RopeWrapTraces = 0;
+	float PeakMemoryMB = 0.f;
+
+	for (const FFrameSample& Sample : Samples)
+	{
+		Csv += FString::Printf(TEXT("%.4f,%.3f,%.3f,%.4f,%.4f,%.4f,%d,%d,%d,%.1f\n"), Sample.Time, Sample.FrameMs, Sample.GameThreadMs, Sample.CharacterTickMs, Sample.HookTickMs, Sample.SwingMs, Sample.ActiveHooks, Sample.LockedRopes, Sample.RopeWrapTraces, Sample.UsedMemoryMB);
+
+		FrameMs.Add(Sample.FrameMs);
+		GameThreadMs.Add(Sample.GameThreadMs);
+		TotalFrameMs += Sample.FrameMs;
+		TotalGameThreadMs += Sample.GameThreadMs;
+		CharacterTickMs += Sample.CharacterTickMs;
+		HookTickMs += Sample.HookTickMs;
+		SwingMs += Sample.SwingMs;
+		RopeWrapTraces += Sample.RopeWrapTraces;
+		PeakMemoryMB = FMath::Max(PeakMemoryMB, Sample.UsedMemoryMB);
+	}
+
+	const int32 NumSamples = FMath::Max(Samples.Num(), 1);
+	const AGH_ActorPool* ActorPool = AGH_ActorPool::Get(GetWorld());
+
+	const FString Json = FString::Printf(TEXT("{\n")
+		TEXT("\t\"bots\": %d,\n")
+		TEXT("\t\"swingBots\": %s,\n")
+		TEXT("\t\"hooksPerBot\": %d,\n")
+		TEXT("\t\"frames\": %d,\n")
+		TEXT("\t\"duration\": %.2f,\n")
+		TEXT("\t\"frameMs\": { \"average\": %.3f, \"p50\": %.3f, \"p95\": %.3f, \"p99\": %.3f, \"max\": %.3f },\n")
+		TEXT("\t\"gameThreadMs\": { \"average\": %.3f, \"p50\": %.3f, \"p95\": %.3f, \"p99\": %.3f, \"max\": %.3f },\n")
+		TEXT("\t\"characterTickMs\": %.4f,\n")
+		TEXT("\t\"hookTickMs\": %.4f,\n")
+		TEXT("\t\"swingMs\": %.4f,\n")
+		TEXT("\t\"ropeWrapTracesPerSecond\": %.1f,\n")
+		TEXT("\t\"pooledSpawns\": %d,\n")
+		TEXT("\t\"poolReuses\": %d,\n")
+		TEXT("\t\"peakMemoryMB\": %.1f\n")
+		TEXT("}\n"),
+		Bots.Num(), bSwingBots ? TEXT("true") : TEXT("false"), HooksPerBot, Samples.Num(), Duration,
+		TotalFrameMs / NumSamples, GetPercentile(FrameMs, 0.5f), GetPercentile(FrameMs, 0.95f), GetPercentile(FrameMs, 0.99f), GetPercentile(FrameMs, 1.f),
+		TotalGameThreadMs / NumSamples, GetPercentile(GameThreadMs, 0.5f), GetPercentile(GameThreadMs, 0.95f), GetPercentile(GameThreadMs, 0.99f), GetPercentile(GameThreadMs, 1.f),
+		CharacterTickMs / NumSamples, HookTickMs / NumSamples, SwingMs / NumSamples,
+		RopeWrapTraces / FMath::Max(Duration, 1.f),
+		ActorPool != nullptr ? ActorPool->GetNumMisses() : 0, ActorPool != nullptr ? ActorPool->GetNumHits() : 0,
+		PeakMemoryMB);
+
+	FFileHelper::SaveStringToFile(Csv, *(BaseName + TEXT(".csv")));
+	FFileHelper::SaveStringToFile(Json, *(BaseName + TEXT(".json")));
+	UE_LOG(LogGHBenchmark, Log, TEXT("Benchmark done, %d frames written to %s.csv/.json"), Samples.Num(), *BaseName);
+
+	if (!GIsEditor)
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
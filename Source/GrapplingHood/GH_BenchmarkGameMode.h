@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GrapplingHoodGameMode.h"
+#include "GH_BenchmarkGameMode.generated.h"
+
+class AGH_Character;
+
+/**
+ * Stress run of the grappling code: spawns bots swinging from anchor to anchor along the swing graph of the level,
+ * or firing, swinging and retracting on a fixed schedule when the level has no anchor index. Samples the frame costs and writes them to Saved/Benchmarks as a per-frame CSV and a JSON summary, then quits.
+ * The rope wrap traces of the swinging bots are counted too, the level geometry they swing around gives the trace rate per second.
+ * Runs headless, e.g.
+ * UE4Editor GrapplingHood /Game/FirstPersonCPP/Maps/FirstPersonExampleMap?game=/Script/GrapplingHood.GH_BenchmarkGameMode?Bots=128?Hooks=2?Duration=60 -game -nullrhi -unattended
+ */
+UCLASS(config = Game)
+class GRAPPLINGHOOD_API AGH_BenchmarkGameMode : public AGrapplingHoodGameMode
+{
+	GENERATED_BODY()
+
+public:
+	AGH_BenchmarkGameMode();
+
+	/** Number of bots spawned, overridden by the Bots= option */
+	UPROPERTY(EditAnywhere, Config, Category = Benchmark, meta = (ClampMin = "0"))
+	int32 NumBots = 64;
+
+	/** Length of the measured run (in s), overridden by the Duration= option */
+	UPROPERTY(EditAnywhere, Config, Category = Benchmark, meta = (ClampMin = "1"))
+	float Duration = 30.f;
+
+	/** Time before the measures start, to let the pools and caches warm up (in s), overridden by the Warmup= option */
+	UPROPERTY(EditAnywhere, Config, Category = Benchmark, meta = (ClampMin = "0"))
+	float Warmup = 5.f;
+
+	/** Length of one fire, swing and retract cycle of a bot (in s) */
+	UPROPERTY(EditAnywhere, Config, Category = Benchmark, meta = (ClampMin = "0.5"))
+	float CyclePeriod = 3.f;
+
+	/** Part of the cycle the bot stays on its rope before releasing it */
+	UPROPERTY(EditAnywhere, Config, Category = Benchmark, meta = (ClampMin = "0", ClampMax = "1"))
+	float HookedFraction = 0.8f;
+
+	/** Distance between the bots (in cm) */
+	UPROPERTY(EditAnywhere, Config, Category = Benchmark)
+	float BotSpacing = 300.f;
+
+	/** Hooks carried by each bot, the scheduled bots fire them all fanned out in yaw. Overridden by the Hooks= option */
+	UPROPERTY(EditAnywhere, Config, Category = Benchmark, meta = (ClampMin = "1", ClampMax = "4"))
+	int32 HooksPerBot = 1;
+
+	/** Yaw between two hooks fired by a scheduled bot (in degrees) */
+	UPROPERTY(EditAnywhere, Config, Category = Benchmark)
+	float HookSpreadYaw = 30.f;
+
+	/** Bots follow the swing graph of the level with AGH_SwingBotController when it has one, overridden by the SwingBots= option */
+	UPROPERTY(EditAnywhere, Config, Category = Benchmark)
+	bool bSwingBots = true;
+
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+	virtual void StartPlay() override;
+	virtual void Tick(float DeltaSeconds) override;
+
+protected:
+	/** Costs of one frame */
+	struct FFrameSample
+	{
+		float Time;
+		float FrameMs;
+		float GameThreadMs;
+		float CharacterTickMs;
+		float HookTickMs;
+		float SwingMs;
+		int32 ActiveHooks;
+		int32 LockedRopes;
+		int32 RopeWrapTraces;
+		float UsedMemoryMB;
+	};
+
+	/** Fires or releases the hooks of the scheduled bots */
+	void UpdateBots(float Now);
+
+	/** Writes the CSV and JSON reports and quits */
+	void FinishBenchmark();
+
+	UPROPERTY(Transient)
+	TArray<AGH_Character*> Bots;
+
+	TArray<FFrameSample> Samples;
+
+	float StartTime = 0.f;
+	bool bFinished = false;
+};
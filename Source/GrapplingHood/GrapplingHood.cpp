@@ -3,5 +3,13 @@
 #include "GrapplingHood.h"
 #include "Modules/ModuleManager.h"
 
+CSV_DEFINE_CATEGORY_MODULE(GRAPPLINGHOOD_API, Grappling, true);
+
+FGH_FrameCounters& FGH_FrameCounters::Get()
+{
+	static FGH_FrameCounters Counters;
+	return Counters;
+}
+
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, GrapplingHood, "GrapplingHood" );
  
\ No newline at end of file
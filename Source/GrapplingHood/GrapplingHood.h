@@ -3,3 +3,42 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+/** Stats of the hook, rope and swing code, shown with "stat grappling" */
+DECLARE_STATS_GROUP(TEXT("Grappling"), STATGROUP_Grappling, STATCAT_Advanced);
+
+/** CSV profiler category of the grappling code (-csvCategories=Grappling) */
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(GRAPPLINGHOOD_API, Grappling);
+
+/**
+ * Times a scope in the STAT_GH_<Name> cycle stat, as a named event for the external profilers
+ * and in the Grappling CSV category
+ */
+#define GH_SCOPE_CYCLE_COUNTER(Name) \
+	SCOPE_CYCLE_COUNTER(STAT_GH_##Name); \
+	SCOPED_NAMED_EVENT(GH_##Name, FColor::Orange); \
+	CSV_SCOPED_TIMING_STAT(Grappling, Name)
+
+/** Time spent in the grappling code during the current frame, read by AGH_BenchmarkGameMode */
+struct GRAPPLINGHOOD_API FGH_FrameCounters
+{
+	uint32 CharacterTickCycles = 0;
+	uint32 HookTickCycles = 0;
+	uint32 SwingCycles = 0;
+	uint32 RopeWrapTraces = 0;
+
+	static FGH_FrameCounters& Get();
+
+	void Reset() { *this = FGH_FrameCounters(); }
+};
+
+/** Adds the cycles spent in the scope to a frame counter, game thread only */
+struct FGH_ScopedFrameCycles
+{
+	FGH_ScopedFrameCycles(uint32& InCounter) : Counter(InCounter), StartCycles(FPlatformTime::Cycles()) {}
+	~FGH_ScopedFrameCycles() { Counter += FPlatformTime::Cycles() - StartCycles; }
+
+	uint32& Counter;
+	uint32 StartCycles;
+};
@@ -2,6 +2,7 @@
 
 #include "GrapplingHoodCharacter.h"
 #include "GrapplingHoodProjectile.h"
+#include "GH_ActorPool.h"
 #include "Animation/AnimInstance.h"
 #include "Camera/CameraComponent.h"
 #include "Components/CapsuleComponent.h"
@@ -103,6 +104,12 @@ void AGrapplingHoodCharacter::BeginPlay()
 		VR_Gun->SetHiddenInGame(true, true);
 		Mesh1P->SetHiddenInGame(false, true);
 	}
+
+	ProjectilePool = AGH_ActorPool::Get(GetWorld());
+	if (ProjectilePool != nullptr)
+	{
+		ProjectilePool->Prewarm(ProjectileClass);
+	}
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -143,14 +150,13 @@ void AGrapplingHoodCharacter::OnFire()
 	// try and fire a projectile
 	if (ProjectileClass != NULL)
 	{
-		UWorld* const World = GetWorld();
-		if (World != NULL)
+		if (ProjectilePool != NULL)
 		{
 			if (bUsingMotionControllers)
 			{
 				const FRotator SpawnRotation = VR_MuzzleLocation->GetComponentRotation();
 				const FVector SpawnLocation = VR_MuzzleLocation->GetComponentLocation();
-				World->SpawnActor<AGrapplingHoodProjectile>(ProjectileClass, SpawnLocation, SpawnRotation);
+				ProjectilePool->Acquire<AGrapplingHoodProjectile>(ProjectileClass, FTransform(SpawnRotation, SpawnLocation), this, this);
 			}
 			else
 			{
@@ -158,12 +164,8 @@ void AGrapplingHoodCharacter::OnFire()
 				// MuzzleOffset is in camera space, so transform it to world space before offsetting from the character location to find the final muzzle position
 				const FVector SpawnLocation = ((FP_MuzzleLocation != nullptr) ? FP_MuzzleLocation->GetComponentLocation() : GetActorLocation()) + SpawnRotation.RotateVector(GunOffset);
 
-				//Set Spawn Collision Handling Override
-				FActorSpawnParameters ActorSpawnParams;
-				ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
-
-				// spawn the projectile at the muzzle
-				World->SpawnActor<AGrapplingHoodProjectile>(ProjectileClass, SpawnLocation, SpawnRotation, ActorSpawnParams);
+				// take a projectile from the pool at the muzzle
+				ProjectilePool->Acquire<AGrapplingHoodProjectile>(ProjectileClass, FTransform(SpawnRotation, SpawnLocation), this, this);
 			}
 		}
 	}
@@ -81,6 +81,9 @@ public:
 	uint32 bUsingMotionControllers : 1;
 
 protected:
+	/** Pool recycling the fired projectiles */
+	UPROPERTY(Transient)
+	class AGH_ActorPool* ProjectilePool;
 	
 	/** Fires a projectile. */
 	void OnFire();
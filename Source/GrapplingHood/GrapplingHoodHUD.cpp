@@ -1,12 +1,30 @@
 // Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
 
 #include "GrapplingHoodHUD.h"
+#include "GrapplingHood.h"
+#include "Character/GH_Character.h"
+#include "Character/GH_HookTargeting.h"
 #include "Engine/Canvas.h"
 #include "Engine/Texture2D.h"
 #include "TextureResource.h"
 #include "CanvasItem.h"
+#include "CanvasTypes.h"
+#include "BatchedElements.h"
+#include "HAL/IConsoleManager.h"
 #include "UObject/ConstructorHelpers.h"
 
+DECLARE_CYCLE_STAT(TEXT("Swing preview"), STAT_GH_SwingPreview, STATGROUP_Grappling);
+
+static TAutoConsoleVariable<int32> CVarSwingPreview(
+	TEXT("gh.HUD.SwingPreview"),
+	1,
+	TEXT("Draws the predicted swing arc and release curve of the local character.\n")
+	TEXT(" 0: off\n")
+	TEXT(" 1: on (default)"),
+	ECVF_Default);
+
+static_assert(sizeof(FVector) == sizeof(FGH_SwingVector), "The preview points are written by the swing core");
+
 AGrapplingHoodHUD::AGrapplingHoodHUD()
 {
 	// Set the crosshair texture
@@ -28,8 +46,64 @@ void AGrapplingHoodHUD::DrawHUD()
 	const FVector2D CrosshairDrawPosition( (Center.X),
 										   (Center.Y + 20.0f));
 
-	// draw the crosshair
-	FCanvasTileItem TileItem( CrosshairDrawPosition, CrosshairTex->Resource, FLinearColor::White);
+	// draw the crosshair, tinted while the hook has something to attach to
+	const AGH_HookTargeting* HookTargeting = AGH_HookTargeting::Get(GetWorld());
+	const FGH_HookTarget* HookTarget = HookTargeting != nullptr ? HookTargeting->FindTarget(Cast<AGH_Character>(GetOwningPawn())) : nullptr;
+	FCanvasTileItem TileItem( CrosshairDrawPosition, CrosshairTex->Resource, HookTarget != nullptr && HookTarget->bValid ? HookTargetColor : FLinearColor::White);
 	TileItem.BlendMode = SE_BLEND_Translucent;
 	Canvas->DrawItem( TileItem );
+
+	if (CVarSwingPreview.GetValueOnGameThread() != 0)
+	{
+		DrawSwingPreview();
+	}
+}
+
+void AGrapplingHoodHUD::BeginPlay()
+{
+	Super::BeginPlay();
+
+	PreviewPoints.SetNumUninitialized(NumArcPoints + NumReleasePoints);
+}
+
+void AGrapplingHoodHUD::DrawSwingPreview()
+{
+	GH_SCOPE_CYCLE_COUNTER(SwingPreview);
+
+	const AGH_Character* Character = Cast<AGH_Character>(GetOwningPawn());
+	FGH_PendulumState State;
+	if (Character == nullptr || PreviewPoints.Num() != NumArcPoints + NumReleasePoints || !Character->GetSwingState(State))
+	{
+		return;
+	}
+
+	// Closed form from the pendulum state, the character simulation is not stepped
+	const float Gravity = Character->GetSwingSettings().Gravity;
+	FGH_SwingVector* Offsets = reinterpret_cast<FGH_SwingVector*>(PreviewPoints.GetData());
+	FGH_Pendulum::PredictArc(State, Gravity, NumArcPoints, Offsets);
+	FGH_Pendulum::PredictRelease(State, Gravity, ReleasePreviewTime, NumReleasePoints, Offsets + NumArcPoints);
+
+	// Every segment goes to the same canvas batch, drawn as one line list
+	FBatchedElements* Lines = Canvas->Canvas->GetBatchedElements(FCanvas::ET_Line);
+	Lines->AddReserveLines(PreviewPoints.Num());
+
+	const FVector Origin = Character->GetSwingOrigin();
+	AddPreviewLines(Lines, Origin, 0, NumArcPoints, ArcColor);
+	AddPreviewLines(Lines, Origin, NumArcPoints, PreviewPoints.Num(), ReleaseColor);
+}
+
+void AGrapplingHoodHUD::AddPreviewLines(FBatchedElements* Lines, const FVector& Origin, int32 Begin, int32 End, const FLinearColor& Color)
+{
+	FVector Previous = Canvas->Project(Origin + PreviewPoints[Begin]);
+	for (int32 Point = Begin + 1; Point < End; ++Point)
+	{
+		const FVector Projected = Canvas->Project(Origin + PreviewPoints[Point]);
+
+		// Project leaves a zero depth to the points behind the camera
+		if (Previous.Z > 0.f && Projected.Z > 0.f)
+		{
+			Lines->AddLine(FVector(Previous.X, Previous.Y, 0.f), FVector(Projected.X, Projected.Y, 0.f), Color, FHitProxyId());
+		}
+		Previous = Projected;
+	}
 }
@@ -14,12 +14,45 @@ class AGrapplingHoodHUD : public AHUD
 public:
 	AGrapplingHoodHUD();
 
+	/** Points of the predicted swing arc, up to where the swing turns back */
+	UPROPERTY(EditAnywhere, Config, Category = "Swing Preview", meta = (ClampMin = "2", ClampMax = "256"))
+	int32 NumArcPoints = 32;
+
+	/** Points of the predicted flight after releasing the rope */
+	UPROPERTY(EditAnywhere, Config, Category = "Swing Preview", meta = (ClampMin = "2", ClampMax = "256"))
+	int32 NumReleasePoints = 24;
+
+	/** Length of the predicted flight after releasing the rope (in s) */
+	UPROPERTY(EditAnywhere, Config, Category = "Swing Preview", meta = (ClampMin = "0"))
+	float ReleasePreviewTime = 1.5f;
+
+	UPROPERTY(EditAnywhere, Config, Category = "Swing Preview")
+	FLinearColor ArcColor = FLinearColor(0.2f, 0.8f, 1.f);
+
+	UPROPERTY(EditAnywhere, Config, Category = "Swing Preview")
+	FLinearColor ReleaseColor = FLinearColor(1.f, 0.6f, 0.1f);
+
+	/** Crosshair tint while the hook targeting trace is over a surface the hook can reach */
+	UPROPERTY(EditAnywhere, Config, Category = "Crosshair")
+	FLinearColor HookTargetColor = FLinearColor(0.3f, 1.f, 0.3f);
+
+	virtual void BeginPlay() override;
+
 	/** Primary draw call for the HUD */
 	virtual void DrawHUD() override;
 
 private:
+	/** Draws the swing arc and release curve predicted from the pendulum state of the owning character */
+	void DrawSwingPreview();
+
+	/** Adds the segments joining the projected points to the canvas line batch */
+	void AddPreviewLines(class FBatchedElements* Lines, const FVector& Origin, int32 Begin, int32 End, const FLinearColor& Color);
+
 	/** Crosshair asset pointer */
 	class UTexture2D* CrosshairTex;
 
+	/** Predicted offsets from the swing origin, the arc followed by the release curve, allocated once */
+	TArray<FVector> PreviewPoints;
+
 };
 
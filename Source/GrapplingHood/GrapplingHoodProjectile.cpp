@@ -38,6 +38,40 @@ void AGrapplingHoodProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* Other
 	{
 		OtherComp->AddImpulseAtLocation(GetVelocity() * 100.0f, GetActorLocation());
 
+		Recycle();
+	}
+}
+
+void AGrapplingHoodProjectile::LifeSpanExpired()
+{
+	Recycle();
+}
+
+void AGrapplingHoodProjectile::OnAcquiredFromPool(AGH_ActorPool* Pool)
+{
+	OwningPool = Pool;
+
+	// Relaunch along the new rotation and restart the lifespan
+	ProjectileMovement->SetUpdatedComponent(CollisionComp);
+	ProjectileMovement->SetVelocityInLocalSpace(FVector::ForwardVector * ProjectileMovement->InitialSpeed);
+	ProjectileMovement->Activate(true);
+	SetLifeSpan(InitialLifeSpan);
+}
+
+void AGrapplingHoodProjectile::OnReleasedToPool()
+{
+	ProjectileMovement->StopMovementImmediately();
+	ProjectileMovement->Deactivate();
+}
+
+void AGrapplingHoodProjectile::Recycle()
+{
+	if (OwningPool != nullptr)
+	{
+		OwningPool->Release(this);
+	}
+	else
+	{
 		Destroy();
 	}
-}
\ No newline at end of file
+}
@@ -4,10 +4,11 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "GH_ActorPool.h"
 #include "GrapplingHoodProjectile.generated.h"
 
 UCLASS(config=Game)
-class AGrapplingHoodProjectile : public AActor
+class AGrapplingHoodProjectile : public AActor, public IGH_Poolable
 {
 	GENERATED_BODY()
 
@@ -26,9 +27,25 @@ public:
 	UFUNCTION()
 	void OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
 
+	/** Goes back to the pool instead of being destroyed */
+	virtual void LifeSpanExpired() override;
+
+	// IGH_Poolable interface
+	virtual void OnAcquiredFromPool(AGH_ActorPool* Pool) override;
+	virtual void OnReleasedToPool() override;
+	// End of IGH_Poolable interface
+
 	/** Returns CollisionComp subobject **/
 	FORCEINLINE class USphereComponent* GetCollisionComp() const { return CollisionComp; }
 	/** Returns ProjectileMovement subobject **/
 	FORCEINLINE class UProjectileMovementComponent* GetProjectileMovement() const { return ProjectileMovement; }
+
+private:
+	/** Pool the projectile returns to, null when spawned directly */
+	UPROPERTY(Transient)
+	AGH_ActorPool* OwningPool = nullptr;
+
+	/** Gives the projectile back to its pool, or destroys it */
+	void Recycle();
 };
 
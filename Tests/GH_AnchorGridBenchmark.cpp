@@ -0,0 +1,136 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GH_Check.h"
+#include "GH_AnchorGrid.h"
+#include "GH_SwingGraph.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+/** Linear search matching FGH_AnchorGrid::FindNearestInCone, the reference of the grid queries */
+static int32_t FindNearestInConeBruteForce(const std::vector<FGH_SwingVector>& Anchors, const FGH_SwingVector& Origin, const FGH_SwingVector& Direction, float CosHalfAngle, float MaxDistance)
+{
+	int32_t BestAnchor = -1;
+	float BestDistanceSquared = MaxDistance * MaxDistance;
+	for (int32_t Anchor = 0; Anchor < static_cast<int32_t>(Anchors.size()); ++Anchor)
+	{
+		const FGH_SwingVector ToAnchor = Anchors[Anchor] - Origin;
+		const float DistanceSquared = FGH_SwingVector::Dot(ToAnchor, ToAnchor);
+		if (DistanceSquared < BestDistanceSquared && FGH_SwingVector::Dot(ToAnchor, Direction) >= CosHalfAngle * std::sqrt(DistanceSquared))
+		{
+			BestAnchor = Anchor;
+			BestDistanceSquared = DistanceSquared;
+		}
+	}
+	return BestAnchor;
+}
+
+/** Links refused by the filter leave their place to the next closest candidates */
+static void TestSwingLinkFilter()
+{
+	// A line of anchors 500 cm apart
+	std::vector<FGH_SwingVector> Anchors;
+	for (int Anchor = 0; Anchor < 20; ++Anchor)
+	{
+		Anchors.push_back(FGH_SwingVector(500.f * Anchor, 0.f, 0.f));
+	}
+
+	FGH_AnchorGrid Grid;
+	Grid.Build(Anchors.data(), static_cast<int32_t>(Anchors.size()), 1000.f);
+
+	FGH_SwingLinkSettings Settings;
+	Settings.MaxDistance = 10000.f;
+	Settings.MaxLinksPerAnchor = 4;
+
+	// Blocks every link ending on an anchor of odd X, e.g. a wall in front of them
+	const std::vector<FGH_SwingVector>& GridAnchors = Grid.GetAnchors();
+	FGH_SwingGraph Graph;
+	Graph.Build(Grid, Settings, [&GridAnchors](int32_t, int32_t To) { return static_cast<int>(GridAnchors[To].X / 500.f) % 2 == 0; });
+
+	int NumBlocked = 0;
+	for (const int32_t Link : Graph.GetLinks())
+	{
+		NumBlocked += static_cast<int>(GridAnchors[Link].X / 500.f) % 2 != 0 ? 1 : 0;
+	}
+	GH_CHECK(NumBlocked == 0, "%d blocked links kept", NumBlocked);
+	GH_CHECK(Graph.GetNumLinks() == 20 * 4, "%d links, every anchor has 4 reachable ones", Graph.GetNumLinks());
+}
+
+int main()
+{
+	TestSwingLinkFilter();
+
+	const int32_t NumAnchors = 100000;
+	const int NumQueries = 100000;
+	const int NumCheckedQueries = 500;
+	const float CellSize = 1000.f;
+	const float MaxDistance = 5000.f;
+	const float CosHalfAngle = std::cos(15.f * 3.14159265f / 180.f);
+
+	// Anchors spread over a 4 km wide, 200 m high level
+	std::mt19937 Random(1234);
+	std::uniform_real_distribution<float> Horizontal(-200000.f, 200000.f);
+	std::uniform_real_distribution<float> Vertical(0.f, 20000.f);
+	std::uniform_real_distribution<float> Unit(-1.f, 1.f);
+
+	std::vector<FGH_SwingVector> Anchors(NumAnchors);
+	for (FGH_SwingVector& Anchor : Anchors)
+	{
+		Anchor = FGH_SwingVector(Horizontal(Random), Horizontal(Random), Vertical(Random));
+	}
+
+	const auto BuildStart = std::chrono::steady_clock::now();
+	FGH_AnchorGrid Grid;
+	Grid.Build(Anchors.data(), NumAnchors, CellSize);
+	std::printf("Anchor grid, %d anchors: built in %.2f ms, %d cells\n", NumAnchors, GetSecondsSince(BuildStart) * 1.e3, static_cast<int>(Grid.GetCellKeys().size()));
+
+	std::vector<FGH_SwingVector> Origins(NumQueries);
+	std::vector<FGH_SwingVector> Directions(NumQueries);
+	for (int Query = 0; Query < NumQueries; ++Query)
+	{
+		Origins[Query] = FGH_SwingVector(Horizontal(Random), Horizontal(Random), Vertical(Random));
+		FGH_SwingVector Direction(Unit(Random), Unit(Random), 0.5f + 0.5f * Unit(Random));
+		Directions[Query] = Direction * (1.f / Direction.Size());
+	}
+
+	// The grid sorts its anchors, the results are compared by location
+	int NumMismatches = 0;
+	for (int Query = 0; Query < NumCheckedQueries; ++Query)
+	{
+		const int32_t Found = Grid.FindNearestInCone(Origins[Query], Directions[Query], CosHalfAngle, MaxDistance);
+		const int32_t Expected = FindNearestInConeBruteForce(Anchors, Origins[Query], Directions[Query], CosHalfAngle, MaxDistance);
+		const bool bSame = Found < 0 || Expected < 0 ? Found == Expected : (Grid.GetAnchors()[Found] - Anchors[Expected]).Size() < 1.e-3f;
+		NumMismatches += bSame ? 0 : 1;
+	}
+	GH_CHECK(NumMismatches == 0, "%d of %d cone queries differ from the linear search", NumMismatches, NumCheckedQueries);
+
+	int NumFound = 0;
+	const auto ConeStart = std::chrono::steady_clock::now();
+	for (int Query = 0; Query < NumQueries; ++Query)
+	{
+		NumFound += Grid.FindNearestInCone(Origins[Query], Directions[Query], CosHalfAngle, MaxDistance) >= 0 ? 1 : 0;
+	}
+	const double ConeSeconds = GetSecondsSince(ConeStart);
+	std::printf("Cone query, 15 degrees, %.0f m: %.3f us per query, %d%% found\n", MaxDistance / 100.f, ConeSeconds * 1.e6 / NumQueries, NumFound * 100 / NumQueries);
+
+	const auto LinearStart = std::chrono::steady_clock::now();
+	for (int Query = 0; Query < NumCheckedQueries; ++Query)
+	{
+		NumFound += FindNearestInConeBruteForce(Anchors, Origins[Query], Directions[Query], CosHalfAngle, MaxDistance) >= 0 ? 1 : 0;
+	}
+	std::printf("Linear search: %.3f us per query\n", GetSecondsSince(LinearStart) * 1.e6 / NumCheckedQueries);
+
+	std::vector<int32_t> InRadius;
+	size_t NumInRadius = 0;
+	const auto RadiusStart = std::chrono::steady_clock::now();
+	for (int Query = 0; Query < NumQueries; ++Query)
+	{
+		InRadius.clear();
+		Grid.FindInRadius(Origins[Query], 2000.f, InRadius);
+		NumInRadius += InRadius.size();
+	}
+	std::printf("Radius query, 20 m: %.3f us per query, %.2f anchors per query\n", GetSecondsSince(RadiusStart) * 1.e6 / NumQueries, static_cast<double>(NumInRadius) / NumQueries);
+
+	return ReportChecks("GH_AnchorGridBenchmark");
+}
@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Minimal checks shared by the standalone tests, a failed check is reported and fails the run.
+
+#include <chrono>
+#include <cstdio>
+
+static int GNumFailedChecks = 0;
+
+#define GH_CHECK(Condition, ...) \
+	do \
+	{ \
+		if (!(Condition)) \
+		{ \
+			std::printf("FAILED %s:%d: %s: ", __FILE__, __LINE__, #Condition); \
+			std::printf(__VA_ARGS__); \
+			std::printf("\n"); \
+			++GNumFailedChecks; \
+		} \
+	} while (0)
+
+/** Seconds elapsed since Start */
+inline double GetSecondsSince(const std::chrono::steady_clock::time_point& Start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+}
+
+/** Prints the result and returns the process exit code */
+inline int ReportChecks(const char* Name)
+{
+	std::printf("%s: %s\n", Name, GNumFailedChecks == 0 ? "passed" : "FAILED");
+	return GNumFailedChecks == 0 ? 0 : 1;
+}
@@ -0,0 +1,229 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GH_Check.h"
+#include "GH_PendulumBatch.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+static const float Pi = 3.14159265f;
+
+/** Ropes stored as the swing manager stores them */
+struct FRopeArrays
+{
+	std::vector<float> Angle;
+	std::vector<float> AngleVelocity;
+	std::vector<float> PreviousAngle;
+	std::vector<float> RopeLength;
+	std::vector<float> ReelSpeed;
+
+	explicit FRopeArrays(int Count) : Angle(Count), AngleVelocity(Count), PreviousAngle(Count), RopeLength(Count), ReelSpeed(Count) {}
+
+	void Step(const FGH_PendulumSettings& Settings)
+	{
+		FGH_PendulumBatch::StepSemiImplicitEuler(Angle.data(), AngleVelocity.data(), PreviousAngle.data(), RopeLength.data(), ReelSpeed.data(), static_cast<int32_t>(Angle.size()), Settings);
+	}
+};
+
+/** The batch gives the results of FGH_Pendulum::Step for any mix of reeling and still ropes in a group of four */
+static void TestBatchMatchesScalar()
+{
+	const int NumRopes = 1027;
+	const int NumSteps = 600;
+
+	FGH_PendulumSettings Settings;
+	Settings.MinRopeLength = 300.f;
+	Settings.MaxRopeLength = 3000.f;
+
+	std::mt19937 Random(42);
+	std::uniform_real_distribution<float> AngleDistribution(Pi - 1.5f, Pi + 1.5f);
+	std::uniform_real_distribution<float> LengthDistribution(200.f, 4000.f);
+	std::uniform_int_distribution<int> ReelDistribution(-2, 2);
+
+	// Lengths also beyond the limits, as locked from farther than MaxRopeLength. Half the ropes keep their length
+	FRopeArrays Batch(NumRopes);
+	std::vector<FGH_PendulumState> Scalar(NumRopes);
+	for (int Rope = 0; Rope < NumRopes; ++Rope)
+	{
+		FGH_PendulumState& State = Scalar[Rope];
+		State.Angle = AngleDistribution(Random);
+		State.AngleVelocity = 0.5f * (AngleDistribution(Random) - Pi);
+		State.RopeLength = LengthDistribution(Random);
+		const int Reel = ReelDistribution(Random);
+		State.ReelSpeed = Reel == -2 || Reel == 2 ? 0.f : 300.f * Reel;
+
+		Batch.Angle[Rope] = State.Angle;
+		Batch.AngleVelocity[Rope] = State.AngleVelocity;
+		Batch.RopeLength[Rope] = State.RopeLength;
+		Batch.ReelSpeed[Rope] = State.ReelSpeed;
+	}
+
+	// The swings near the top amplify any rounding difference, the angles are compared step by step from the batch state.
+	// The lengths do not depend on the angles, they are compared on the whole run
+	float MaxAngleError = 0.f;
+	float MaxVelocityError = 0.f;
+	for (int Step = 0; Step < NumSteps; ++Step)
+	{
+		for (int Rope = 0; Rope < NumRopes; ++Rope)
+		{
+			Scalar[Rope].Angle = Batch.Angle[Rope];
+			Scalar[Rope].AngleVelocity = Batch.AngleVelocity[Rope];
+			FGH_Pendulum::Step(Scalar[Rope], Settings, Settings.FixedTimeStep);
+		}
+		Batch.Step(Settings);
+
+		for (int Rope = 0; Rope < NumRopes; ++Rope)
+		{
+			MaxAngleError = std::max(MaxAngleError, std::abs(Batch.Angle[Rope] - Scalar[Rope].Angle));
+			MaxVelocityError = std::max(MaxVelocityError, std::abs(Batch.AngleVelocity[Rope] - Scalar[Rope].AngleVelocity) / std::max(1.f, std::abs(Scalar[Rope].AngleVelocity)));
+		}
+	}
+
+	float MaxLengthError = 0.f;
+	int NumReelMismatches = 0;
+	for (int Rope = 0; Rope < NumRopes; ++Rope)
+	{
+		MaxLengthError = std::max(MaxLengthError, std::abs(Batch.RopeLength[Rope] - Scalar[Rope].RopeLength));
+		NumReelMismatches += (Batch.ReelSpeed[Rope] != 0.f) != (Scalar[Rope].ReelSpeed != 0.f) ? 1 : 0;
+	}
+
+	std::printf("Batch vs scalar over %d steps: per step angle %.2e rad, angular velocity %.2e, final length %.2e cm\n", NumSteps, MaxAngleError, MaxVelocityError, MaxLengthError);
+	GH_CHECK(MaxAngleError < 1.e-5f, "angle differs by %f rad", MaxAngleError);
+	GH_CHECK(MaxVelocityError < 1.e-5f, "angular velocity differs by %f", MaxVelocityError);
+	GH_CHECK(MaxLengthError < 1.e-2f, "length differs by %f cm", MaxLengthError);
+	GH_CHECK(NumReelMismatches == 0, "%d ropes stopped reeling on one side only", NumReelMismatches);
+}
+
+/** Still ropes grouped with reeling ones are untouched by the reel, even when their length is beyond the limits */
+static void TestStillRopesKeepTheirLength()
+{
+	FGH_PendulumSettings Settings;
+	Settings.MinRopeLength = 300.f;
+	Settings.MaxRopeLength = 3000.f;
+
+	FRopeArrays Batch(4);
+	const float Lengths[4] = { 1000.f, 5000.f, 200.f, 5000.f };
+	const float Reels[4] = { -300.f, 0.f, 0.f, -300.f };
+	for (int Rope = 0; Rope < 4; ++Rope)
+	{
+		Batch.Angle[Rope] = Pi + 0.5f;
+		Batch.RopeLength[Rope] = Lengths[Rope];
+		Batch.ReelSpeed[Rope] = Reels[Rope];
+	}
+
+	for (int Step = 0; Step < 60; ++Step)
+	{
+		Batch.Step(Settings);
+	}
+
+	GH_CHECK(Batch.RopeLength[1] == 5000.f && Batch.RopeLength[2] == 200.f, "still ropes reeled to %f and %f", Batch.RopeLength[1], Batch.RopeLength[2]);
+	GH_CHECK(std::abs(Batch.RopeLength[0] - 700.f) < 0.1f, "rope reeled to %f instead of 700", Batch.RopeLength[0]);
+	// Reeled in from beyond the longest length, not snapped to it
+	GH_CHECK(std::abs(Batch.RopeLength[3] - 4700.f) < 0.1f, "rope reeled to %f instead of 4700", Batch.RopeLength[3]);
+}
+
+/** theta'' = (g / L) sin(theta) - 2 (L' / L) theta', integrated with RK4 in double */
+static double IntegrateReelReference(double Angle, double AngleVelocity, double Length, double ReelSpeed, double Gravity, double Duration)
+{
+	const double dt = 1.e-6;
+	const auto Acceleration = [Gravity, ReelSpeed](double A, double W, double L) { return Gravity / L * std::sin(A) - 2.0 * ReelSpeed / L * W; };
+
+	for (double Time = 0.0; Time < Duration - 0.5 * dt; Time += dt)
+	{
+		const double K1A = AngleVelocity;
+		const double K1W = Acceleration(Angle, AngleVelocity, Length);
+		const double K2A = AngleVelocity + 0.5 * dt * K1W;
+		const double K2W = Acceleration(Angle + 0.5 * dt * K1A, K2A, Length + 0.5 * dt * ReelSpeed);
+		const double K3A = AngleVelocity + 0.5 * dt * K2W;
+		const double K3W = Acceleration(Angle + 0.5 * dt * K2A, K3A, Length + 0.5 * dt * ReelSpeed);
+		const double K4A = AngleVelocity + dt * K3W;
+		const double K4W = Acceleration(Angle + dt * K3A, K4A, Length + dt * ReelSpeed);
+		Angle += dt / 6.0 * (K1A + 2.0 * K2A + 2.0 * K3A + K4A);
+		AngleVelocity += dt / 6.0 * (K1W + 2.0 * K2W + 2.0 * K3W + K4W);
+		Length += dt * ReelSpeed;
+	}
+	return AngleVelocity;
+}
+
+/** 1 s of reeling in from 1000 to 400 cm, the angular momentum update against the reference integration */
+static void TestReelAgainstReference()
+{
+	const FGH_PendulumSettings Settings;
+	const float StartAngle = Pi + 0.6f;
+	const float ReelSpeed = -600.f;
+	const int NumSteps = 60;
+
+	const double Reference = IntegrateReelReference(StartAngle, 0.0, 1000.0, ReelSpeed, Settings.Gravity, NumSteps * Settings.FixedTimeStep);
+
+	FRopeArrays Batch(4);
+	for (int Rope = 0; Rope < 4; ++Rope)
+	{
+		Batch.Angle[Rope] = StartAngle;
+		Batch.RopeLength[Rope] = 1000.f;
+		Batch.ReelSpeed[Rope] = ReelSpeed;
+	}
+
+	// Length changed without scaling the angular velocity
+	FGH_PendulumState Naive;
+	Naive.Angle = StartAngle;
+	Naive.RopeLength = 1000.f;
+
+	for (int Step = 0; Step < NumSteps; ++Step)
+	{
+		Batch.Step(Settings);
+		Naive.RopeLength = 1000.f + ReelSpeed * Settings.FixedTimeStep * Step;
+		FGH_Pendulum::Step(Naive, Settings, Settings.FixedTimeStep);
+	}
+
+	const double Error = std::abs(Batch.AngleVelocity[0] - Reference) / std::abs(Reference);
+	const double NaiveError = std::abs(Naive.AngleVelocity - Reference) / std::abs(Reference);
+	std::printf("Reel 1000 -> %.0f cm in 1 s: angular velocity %.4f rad/s, reference %.4f rad/s, %.2f%% off (length alone %.0f%% off)\n",
+		Batch.RopeLength[0], Batch.AngleVelocity[0], Reference, Error * 100.0, NaiveError * 100.0);
+	GH_CHECK(std::abs(Batch.RopeLength[0] - 400.f) < 0.1f, "rope reeled to %f", Batch.RopeLength[0]);
+	GH_CHECK(Error < 0.01, "%.2f%% off the reference", Error * 100.0);
+}
+
+static void BenchmarkBatch()
+{
+	const int NumRopes = 4096;
+	const int NumSteps = 600;
+	const FGH_PendulumSettings Settings;
+
+	FRopeArrays Batch(NumRopes);
+	std::vector<FGH_PendulumState> Scalar(NumRopes);
+	for (int Rope = 0; Rope < NumRopes; ++Rope)
+	{
+		Batch.Angle[Rope] = Scalar[Rope].Angle = Pi + 0.001f * Rope;
+		Batch.RopeLength[Rope] = Scalar[Rope].RopeLength = 1000.f;
+	}
+
+	auto Start = std::chrono::steady_clock::now();
+	for (int Step = 0; Step < NumSteps; ++Step)
+	{
+		Batch.Step(Settings);
+	}
+	const double BatchSeconds = GetSecondsSince(Start);
+
+	Start = std::chrono::steady_clock::now();
+	for (int Step = 0; Step < NumSteps; ++Step)
+	{
+		for (FGH_PendulumState& State : Scalar)
+		{
+			FGH_Pendulum::Step(State, Settings, Settings.FixedTimeStep);
+		}
+	}
+	const double ScalarSeconds = GetSecondsSince(Start);
+
+	const double NumRopeSteps = static_cast<double>(NumRopes) * NumSteps;
+	std::printf("Rope steps/s: batch %.0f, scalar %.0f (x%.1f, checksum %.3f)\n", NumRopeSteps / BatchSeconds, NumRopeSteps / ScalarSeconds, ScalarSeconds / BatchSeconds, Batch.Angle[NumRopes / 2] - Scalar[NumRopes / 2].Angle);
+}
+
+int main()
+{
+	TestBatchMatchesScalar();
+	TestStillRopesKeepTheirLength();
+	TestReelAgainstReference();
+	BenchmarkBatch();
+	return ReportChecks("GH_PendulumBatchTests");
+}
@@ -0,0 +1,164 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GH_Check.h"
+#include "GH_Pendulum.h"
+
+#include <cmath>
+#include <random>
+
+static const float Pi = 3.14159265f;
+
+/** Rope of the given length hanging Amplitude radians away from the rest position */
+static FGH_PendulumState MakeSwing(float RopeLength, float Amplitude)
+{
+	FGH_PendulumState State;
+	State.RopeLength = RopeLength;
+	State.Angle = Pi + Amplitude;
+	State.PlaneNormal = FGH_SwingVector(0.f, 1.f, 0.f);
+	return State;
+}
+
+/** Largest relative energy change over Seconds of swing */
+static float MeasureEnergyDrift(EGH_PendulumIntegrator Integrator, float Seconds)
+{
+	FGH_PendulumSettings Settings;
+	Settings.Integrator = Integrator;
+
+	FGH_PendulumState State = MakeSwing(1000.f, 1.f);
+	const float StartEnergy = FGH_Pendulum::GetEnergy(State, Settings.Gravity);
+	// The energy is relative to the anchor, measured against the swing height
+	const float Scale = Settings.Gravity * State.RopeLength;
+
+	float Drift = 0.f;
+	const int NumSteps = static_cast<int>(Seconds / Settings.FixedTimeStep);
+	for (int Step = 0; Step < NumSteps; ++Step)
+	{
+		FGH_Pendulum::Step(State, Settings, Settings.FixedTimeStep);
+		Drift = std::fmax(Drift, std::fabs(FGH_Pendulum::GetEnergy(State, Settings.Gravity) - StartEnergy) / Scale);
+	}
+	return Drift;
+}
+
+static void TestEnergyConservation()
+{
+	const float EulerDrift = MeasureEnergyDrift(EGH_PendulumIntegrator::SemiImplicitEuler, 60.f);
+	const float VerletDrift = MeasureEnergyDrift(EGH_PendulumIntegrator::Verlet, 60.f);
+	const float RK4Drift = MeasureEnergyDrift(EGH_PendulumIntegrator::RK4, 60.f);
+	std::printf("Energy drift over 60 s: Euler %.5f, Verlet %.5f, RK4 %.7f\n", EulerDrift, VerletDrift, RK4Drift);
+
+	// Symplectic schemes oscillate around the exact energy without drifting, RK4 drifts but slowly
+	GH_CHECK(EulerDrift < 0.01f, "semi-implicit Euler drift %f", EulerDrift);
+	GH_CHECK(VerletDrift < 0.001f, "Verlet drift %f", VerletDrift);
+	GH_CHECK(RK4Drift < 0.0001f, "RK4 drift %f", RK4Drift);
+}
+
+static void TestSmallAnglePeriod()
+{
+	FGH_PendulumSettings Settings;
+	FGH_PendulumState State = MakeSwing(1500.f, 0.05f);
+	const float Expected = FGH_Pendulum::GetSmallAnglePeriod(State.RopeLength, Settings.Gravity);
+
+	// Times between the crossings of the rest position going the same way
+	float Time = 0.f;
+	float FirstCrossing = -1.f;
+	float LastCrossing = -1.f;
+	int NumPeriods = 0;
+	float PreviousOffset = State.Angle - Pi;
+	while (Time < 20.f * Expected)
+	{
+		FGH_Pendulum::Step(State, Settings, Settings.FixedTimeStep);
+		Time += Settings.FixedTimeStep;
+
+		const float Offset = State.Angle - Pi;
+		if (PreviousOffset > 0.f && Offset <= 0.f)
+		{
+			// Crossing time interpolated inside the step
+			const float Crossing = Time - Settings.FixedTimeStep * Offset / (Offset - PreviousOffset);
+			if (FirstCrossing < 0.f)
+			{
+				FirstCrossing = Crossing;
+			}
+			else
+			{
+				++NumPeriods;
+			}
+			LastCrossing = Crossing;
+		}
+		PreviousOffset = Offset;
+	}
+
+	const float Measured = NumPeriods > 0 ? (LastCrossing - FirstCrossing) / NumPeriods : 0.f;
+	std::printf("Small angle period: measured %.4f s, analytic %.4f s\n", Measured, Expected);
+	GH_CHECK(std::fabs(Measured - Expected) < 0.005f * Expected, "period %f, expected %f", Measured, Expected);
+}
+
+/** Moves of any length, combined or not, run the same fixed steps: the client, the server and the replays swing alike */
+static void TestMoveSplits()
+{
+	const FGH_PendulumSettings Settings;
+	std::mt19937 Random(7);
+	std::uniform_real_distribution<float> MoveDistribution(0.008f, 0.033f);
+
+	FGH_FixedStepPendulum Moves;
+	FGH_FixedStepPendulum Combined;
+	Moves.Reset(MakeSwing(1000.f, 1.f));
+	Combined.Reset(MakeSwing(1000.f, 1.f));
+
+	int NumMoveSteps = 0;
+	int NumCombinedSteps = 0;
+	float MaxAngleError = 0.f;
+	for (int Pair = 0; Pair < 300; ++Pair)
+	{
+		const float First = MoveDistribution(Random);
+		const float Second = MoveDistribution(Random);
+		NumMoveSteps += Moves.Advance(Settings, First);
+		NumMoveSteps += Moves.Advance(Settings, Second);
+		NumCombinedSteps += Combined.Advance(Settings, First + Second);
+		MaxAngleError = std::fmax(MaxAngleError, std::fabs(Moves.GetInterpolatedAngle(Settings) - Combined.GetInterpolatedAngle(Settings)));
+	}
+
+	std::printf("Moves split in pairs: %d and %d steps, interpolated angle %.2e rad apart\n", NumMoveSteps, NumCombinedSteps, MaxAngleError);
+	GH_CHECK(NumMoveSteps == NumCombinedSteps, "%d steps, %d when combined", NumMoveSteps, NumCombinedSteps);
+	GH_CHECK(MaxAngleError < 1.e-5f, "combined moves %f rad away", MaxAngleError);
+}
+
+static void BenchmarkSteps()
+{
+	const FGH_PendulumSettings Settings;
+	const int NumRopes = 1024;
+	const int NumSteps = 1000;
+
+	FGH_PendulumState States[NumRopes];
+	for (int Rope = 0; Rope < NumRopes; ++Rope)
+	{
+		States[Rope] = MakeSwing(500.f + Rope, 0.001f * Rope);
+	}
+
+	const auto Start = std::chrono::steady_clock::now();
+	for (int Step = 0; Step < NumSteps; ++Step)
+	{
+		for (FGH_PendulumState& State : States)
+		{
+			FGH_Pendulum::Step(State, Settings, Settings.FixedTimeStep);
+		}
+	}
+	const double Seconds = GetSecondsSince(Start);
+
+	// Reads the states so the loop is not optimized away
+	float Checksum = 0.f;
+	for (const FGH_PendulumState& State : States)
+	{
+		Checksum += State.Angle;
+	}
+	std::printf("Pendulum steps: %.2f M steps/s (checksum %.3f)\n", NumRopes * NumSteps / Seconds / 1.e6, Checksum);
+	GH_CHECK(std::isfinite(Checksum), "non finite state");
+}
+
+int main()
+{
+	TestEnergyConservation();
+	TestSmallAnglePeriod();
+	TestMoveSplits();
+	BenchmarkSteps();
+	return ReportChecks("GH_PendulumTests");
+}
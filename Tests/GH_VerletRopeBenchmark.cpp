@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GH_Check.h"
+#include "GH_VerletRope.h"
+
+#include <cmath>
+#include <vector>
+
+/** Velocity of the middle particle of a rope with an even segment count */
+static FGH_SwingVector GetMiddleVelocity(const FGH_VerletRope& Rope, float StepSeconds)
+{
+	const int32_t Middle = Rope.GetNumSegments() / 2;
+	return (Rope.GetPoints()[Middle] - Rope.GetPreviousPoints()[Middle]) * (1.f / StepSeconds);
+}
+
+static void TestResampleKeepsVelocity()
+{
+	const FGH_VerletRopeSettings Settings;
+	const float StepSeconds = 1.f / 60.f;
+	const FGH_SwingVector Start(0.f, 0.f, 0.f);
+	const FGH_SwingVector End(1000.f, 0.f, 0.f);
+
+	// Slack rope falling from straight, the middle moves fast after a few steps
+	FGH_VerletRope Rope;
+	Rope.Reset(16, Start, End);
+	Rope.SetRestLength(1200.f);
+	for (int Step = 0; Step < 10; ++Step)
+	{
+		Rope.Step(Settings, StepSeconds, Start, End);
+	}
+
+	// The middle particle of 16 and 8 segments sits at the same spot of the rope, it keeps its velocity through the resample
+	const FGH_SwingVector VelocityBefore = GetMiddleVelocity(Rope, StepSeconds);
+	Rope.Resample(8);
+	const FGH_SwingVector VelocityAfter = GetMiddleVelocity(Rope, StepSeconds);
+
+	const float Error = (VelocityAfter - VelocityBefore).Size();
+	std::printf("Middle speed before resample %.1f cm/s, after %.1f cm/s\n", VelocityBefore.Size(), VelocityAfter.Size());
+	GH_CHECK(VelocityBefore.Size() > 10.f, "rope not moving, speed %f", VelocityBefore.Size());
+	GH_CHECK(Error < 0.01f * VelocityBefore.Size(), "velocity changed by %f cm/s", Error);
+}
+
+static void BenchmarkRopes(int32_t NumSegments, int32_t Iterations)
+{
+	const int NumRopes = 256;
+	const int NumSteps = 600;
+	const float StepSeconds = 1.f / 60.f;
+
+	FGH_VerletRopeSettings Settings;
+	Settings.Iterations = Iterations;
+
+	std::vector<FGH_VerletRope> Ropes(NumRopes);
+	for (int Rope = 0; Rope < NumRopes; ++Rope)
+	{
+		Ropes[Rope].Reset(NumSegments, FGH_SwingVector(0.f, 0.f, 0.f), FGH_SwingVector(1000.f, static_cast<float>(Rope), 0.f));
+		Ropes[Rope].SetRestLength(1100.f);
+	}
+
+	const auto Start = std::chrono::steady_clock::now();
+	for (int Step = 0; Step < NumSteps; ++Step)
+	{
+		// Swinging end, the ropes never come to rest
+		const FGH_SwingVector End(1000.f, 0.f, 200.f * std::sin(Step * StepSeconds * 3.f));
+		for (FGH_VerletRope& Rope : Ropes)
+		{
+			Rope.Step(Settings, StepSeconds, FGH_SwingVector(0.f, 0.f, 0.f), End);
+		}
+	}
+	const double Seconds = GetSecondsSince(Start);
+
+	float Checksum = 0.f;
+	for (const FGH_VerletRope& Rope : Ropes)
+	{
+		Checksum += Rope.GetPoints()[NumSegments / 2].Z;
+	}
+	std::printf("Verlet rope, %2d segments, %d iterations: %.3f us per rope step, %.0f rope steps/s (checksum %.1f)\n",
+		NumSegments, Iterations, Seconds * 1.e6 / (NumRopes * NumSteps), NumRopes * NumSteps / Seconds, Checksum);
+	GH_CHECK(std::isfinite(Checksum), "non finite rope");
+}
+
+int main()
+{
+	TestResampleKeepsVelocity();
+
+	// Resolutions of the camera distance LOD, from the closest rope to the farthest simulated one
+	BenchmarkRopes(16, 4);
+	BenchmarkRopes(8, 2);
+	BenchmarkRopes(2, 1);
+	return ReportChecks("GH_VerletRopeBenchmark");
+}